@@ -0,0 +1,110 @@
+/**
+ *  @file    MidiEventListBenchmark.cpp
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Console benchmark timing the insertion of events into a MidiEventList
+ *  against the add & resort it replaced. It isn't part of the app, build it
+ *  as a JUCE console application alongside the JuceLibraryCode modules and
+ *  Source/audio/MidiEventList.cpp, Pattern.cpp & MusicalClock.cpp.
+ *
+ *  Usage: MidiEventListBenchmark [event count, 1000 by default]
+ *
+ */
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../Source/audio/MidiEventList.h"
+
+#include <iostream>
+
+//==============================================================================
+
+namespace
+{
+    /**
+     *  Builds the events to insert, note ons & offs at random ticks.
+     *  @param  count is the number of events.
+     *  @return the events, in the order they are to be inserted.
+     */
+    Array<MidiMessage> makeEvents(const int count)
+    {
+        Random random(42); // the same events on every run
+        Array<MidiMessage> events;
+        
+        for(int i = 0; i < count; ++i)
+        {
+            const int channel = random.nextInt(16) + 1;
+            const int note = random.nextInt(128);
+            
+            MidiMessage event = random.nextBool() ? MidiMessage::noteOn(channel, note, (uint8)90)
+                                                  : MidiMessage::noteOff(channel, note);
+            event.setTimeStamp(random.nextInt(count * 4));
+            events.add(event);
+        }
+        
+        return events;
+    }
+    
+    /**
+     *  Times a function.
+     *  @param  function is the work to time.
+     *  @return the time taken in milliseconds.
+     */
+    template <typename Function>
+    double timeMs(Function function)
+    {
+        const int64 start = Time::getHighResolutionTicks();
+        function();
+        return Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1000.0;
+    }
+}
+
+//==============================================================================
+
+int main (int argc, char* argv[])
+{
+    const int count = argc > 1 ? jmax(1000, String(argv[1]).getIntValue()) : 1000;
+    const Array<MidiMessage> events = makeEvents(count);
+    
+    // the old list appended each event then resorted everything
+    audio::MidiMessageTimestampSorter sorter;
+    Array<MidiMessage> resorted;
+    const double resortMs = timeMs([&]
+    {
+        for(const MidiMessage& event : events)
+        {
+            resorted.add(event);
+            resorted.sort(sorter, true);
+        }
+    });
+    
+    // the current list binary searches for each insert position
+    audio::MidiEventList list;
+    const double insertMs = timeMs([&]
+    {
+        for(const MidiMessage& event : events)
+            list.addMidiEvent(event);
+    });
+    
+    // both must end up in the same order
+    bool matches = list.getSize() == resorted.size();
+    for(int i = 0; matches && i < resorted.size(); ++i)
+        matches = list.getMidiEvent(i).getTimeStamp() == resorted.getReference(i).getTimeStamp()
+               && list.getMidiEvent(i).isNoteOff() == resorted.getReference(i).isNoteOff();
+    
+    std::cout << "Inserting " << count << " events" << std::endl
+              << "  add & resort:     " << resortMs << " ms" << std::endl
+              << "  binary insertion: " << insertMs << " ms" << std::endl
+              << "  speed up:         " << resortMs / jmax(insertMs, 0.001) << "x" << std::endl;
+    
+    if(matches == false)
+    {
+        std::cout << "The lists are ordered differently!" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
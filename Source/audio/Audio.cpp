@@ -12,29 +12,71 @@
 
 namespace audio
 {
-    Audio::Audio()
+    Audio::Audio() : auditionFifo(AUDITION_QUEUE_SIZE),
+                     streamingThread("sample streaming")
     {
-        // initialise oscillators
-        for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+        // initialise oscillators, stems default to an output per row
+        for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
         {
             osc[i].set(&sine[i]);
+            sampler[i].setVoiceIndex(i);
+            voices[i] = { 1, -1, false, 0 };
+            voiceRow[i].set(0);
         }
+        for(int i = 0; i < ROW_TOTAL; ++i)
+        {
+            rowBus[i].set(i);
+            rowStreams[i].set(nullptr);
+        }
+        noteOnCount.set(0);
+        callbackCount.set(0);
+        stemRouting.set(false);
+        oscillatorID.set(1);
+        filterCutoff.set(19999.0f);
+        appliedCutoff = 0.0f; // applied by the first callback
         
         // setup audio processing
-        audioDeviceManager.initialiseWithDefaultDevices (0, 2);
+        // ask for as many outputs as the interface has for stem routing
+        audioDeviceManager.initialiseWithDefaultDevices (0, MAX_OUTPUT_CHANNELS);
         audioDeviceManager.addAudioCallback (this);
         
         // setup visualiser as null unless set
         visualiser = nullptr;
+        
+        // start paging in samples
+        streamingThread.startThread(3);
     }
     
     Audio::~Audio()
     {
+        stopTimer();
         audioDeviceManager.removeAudioCallback (this);
         audioDeviceManager.removeMidiInputCallback("step-sequencer", this);
+        streamingThread.stopThread(1000);
+        
+        // the audio thread is gone, nothing can still be reading these
+        for(auto& retired : retiredStreams)
+            delete retired.stream;
     }
     
-    void Audio::audioDeviceAboutToStart (AudioIODevice* device){}
+    void Audio::audioDeviceAboutToStart (AudioIODevice* device)
+    {
+        const double sampleRate = device->getCurrentSampleRate();
+        
+        for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
+        {
+            sine[i].setSampleRate(sampleRate);
+            square[i].setSampleRate(sampleRate);
+            saw[i].setSampleRate(sampleRate);
+            triangle[i].setSampleRate(sampleRate);
+            sampler[i].setSampleRate(sampleRate);
+        }
+        
+        // allocate scratch space up front so the callback never has to
+        const int blockSize = jmax(1, device->getCurrentBufferSizeSamples());
+        busBuffer.setSize(MAX_OUTPUT_CHANNELS, blockSize);
+        voiceBuffer.setSize(1, blockSize);
+    }
     
     void Audio::audioDeviceIOCallback (const float** inputChannelData,
                                        int numInputChannels,
@@ -42,47 +84,107 @@ namespace audio
                                        int numOutputChannels,
                                        int numSamples)
     {
-        float *outL = outputChannelData[0];
-        float *outR = outputChannelData[1];
-        
         // set amplitude to zero if midi isn't playing or we're changing wave
         if ( MidiOut::getInstance().getPlaying() == false)
         {
-            for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+            for(int i = 0; i < VOICE_COUNT; ++i)
                 osc[i].get()->setAmplitude(0.0f);
         }
         
-        float accumulator = 0.0f;
-        while(numSamples--)
+        // the cutoff is only applied here, so the filters never change mid block
+        const float cutoff = filterCutoff.get();
+        if(cutoff != appliedCutoff)
+        {
+            for(int i = 0; i < MAX_OUTPUT_CHANNELS; ++i)
+                filter[i].setCutoff(cutoff);
+            appliedCutoff = cutoff;
+        }
+        
+        // auditions start on this block, whether or not the sequencer is playing
+        processAuditions();
+        
+        // hand each voice the sample of its row here, so only this thread
+        // holds a stream and a retired one is dropped within the callback
+        for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
+            sampler[i].setStream(rowStreams[voiceRow[i].get() & (ROW_TOTAL - 1)].get());
+        
+        // the buffers were sized in audioDeviceAboutToStart, bigger blocks are rendered a chunk at a time
+        const int chunkSize = busBuffer.getNumSamples();
+        
+        // the device must be started before it calls back!!!
+        jassert(chunkSize > 0);
+        
+        for(int startSample = 0; chunkSize > 0 && startSample < numSamples; startSample += chunkSize)
+            renderChunk(outputChannelData, numOutputChannels, startSample, jmin(chunkSize, numSamples - startSample));
+        
+        // nothing retired before this callback started is read from here on
+        ++callbackCount;
+    }
+    
+    void Audio::renderChunk(float** outputChannelData,
+                            int numOutputChannels,
+                            int startSample,
+                            int numSamples)
+    {
+        busBuffer.clear(0, numSamples);
+        
+        // stems get a bus per output channel, a mixdown only uses the first
+        const bool stems = stemRouting.get();
+        const int busCount = stems ? jlimit(1, (int)MAX_OUTPUT_CHANNELS, numOutputChannels) : 1;
+        int voicesPerBus[MAX_OUTPUT_CHANNELS] = {};
+        
+        // render each voice and sum it into the bus of the row it last played
+        float* voice = voiceBuffer.getWritePointer(0);
+        for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
         {
-            // sum all oscillators
-            for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+            synthesis::osc::Oscillator* current = osc[i].get();
+            for(int sample = 0; sample < numSamples; ++sample)
             {
-                accumulator += osc[i].get()->getSample();
+                voice[sample] = current->getSample();
             }
             
+            const int bus = stems ? rowBus[voiceRow[i].get() & (ROW_TOTAL - 1)].get() % busCount : 0;
+            FloatVectorOperations::add(busBuffer.getWritePointer(bus), voice, numSamples);
+            voicesPerBus[bus]++;
+        }
+        
+        for(int bus = 0; bus < busCount; ++bus)
+        {
+            float* samples = busBuffer.getWritePointer(bus);
+            
             // scale for no clipping
-            accumulator *= 1.0f / MIDI_CHANNEL_TOTAL;
+            if(voicesPerBus[bus] > 0)
+                FloatVectorOperations::multiply(samples, 1.0f / voicesPerBus[bus], numSamples);
             
             // apply filtering
-            accumulator = filter.process(accumulator);
-            
-            // test for clipping range
-            jassert(accumulator >= -1.0f && accumulator <= 1.0f);
-            
-            // write to output
-            *outL = accumulator;
-            *outR = accumulator;
-            
-            // update visualiser
-            if(visualiser.get() != nullptr)
+            for(int sample = 0; sample < numSamples; ++sample)
             {
-                visualiser.get()->pushSample(outL, 1);
+                samples[sample] = filter[bus].process(samples[sample]);
+                
+                // test for clipping range
+                jassert(samples[sample] >= -1.0f && samples[sample] <= 1.0f);
             }
+        }
+        
+        // write to output, a mixdown is sent to the first stereo pair
+        for(int channel = 0; channel < numOutputChannels; ++channel)
+        {
+            if(outputChannelData[channel] == nullptr)
+                continue;
             
-            // increment to next sample in buffer
-            outL++;
-            outR++;
+            if(stems && channel < busCount)
+                FloatVectorOperations::copy(outputChannelData[channel] + startSample, busBuffer.getReadPointer(channel), numSamples);
+            else if(stems == false && channel < 2)
+                FloatVectorOperations::copy(outputChannelData[channel] + startSample, busBuffer.getReadPointer(0), numSamples);
+            else
+                FloatVectorOperations::clear(outputChannelData[channel] + startSample, numSamples);
+        }
+        
+        // update visualiser
+        if(visualiser.get() != nullptr)
+        {
+            const float* firstBus = busBuffer.getReadPointer(0);
+            visualiser.get()->pushBuffer(&firstBus, 1, numSamples);
         }
     }
     
@@ -100,25 +202,132 @@ namespace audio
     void Audio::handleIncomingMidiMessage (MidiInput* source,
                                            const MidiMessage& message)
     {
-        // so long as the channel is assigned a oscillator wavetype...
-        if(osc[message.getChannel()-1].get() != nullptr)
+        const int channel = message.getChannel();
+        if(channel < 1)
+            return; // not a channel message
+        
+        // release every note of the channel, e.g. when playback stops
+        if(message.isAllNotesOff() || message.isAllSoundOff())
         {
-            // set the appropriate condition based on if note on or note off
-            if( message.isNoteOn() )
+            for(int i = 0; i < VOICE_COUNT; ++i)
             {
-                osc[message.getChannel()-1].get()->setAmplitude( message.getFloatVelocity() );
+                if(voices[i].held && voices[i].channel == channel)
+                {
+                    osc[i].get()->setAmplitude(0.0f);
+                    voices[i].held = false;
+                }
             }
-            else // message.isNoteOff()
+            return;
+        }
+        
+        // the sample & bus are the row's, a note no row sends takes its channel's first row
+        const int row = message.isNoteOn() ? MidiOut::getInstance().getRowForNote(channel, message.getNoteNumber()) : -1;
+        playNote(0, VOICE_COUNT, message, row >= 0 ? row : channel - 1);
+    }
+    
+    //==========================================================================
+    
+    void Audio::auditionNoteOn(int row, int channel, int note, uint8 velocity)
+    {
+        pushAudition(MidiMessage::noteOn(jlimit(1, 16, channel), jlimit(0, 127, note), velocity), jlimit(0, ROW_TOTAL - 1, row));
+    }
+    
+    void Audio::auditionNoteOff(int channel, int note)
+    {
+        pushAudition(MidiMessage::noteOff(jlimit(1, 16, channel), jlimit(0, 127, note), (uint8)0), 0);
+    }
+    
+    void Audio::pushAudition(const MidiMessage& message, int row)
+    {
+        int start1, size1, start2, size2;
+        auditionFifo.prepareToWrite(1, start1, size1, start2, size2);
+        
+        if(size1 == 0)
+            return; // full, the audio device isn't running
+        
+        auditionQueue[start1] = { PlaybackSchedule::packMessage(message), row };
+        auditionFifo.finishedWrite(1);
+    }
+    
+    void Audio::processAuditions()
+    {
+        int start1, size1, start2, size2;
+        auditionFifo.prepareToRead(auditionFifo.getNumReady(), start1, size1, start2, size2);
+        
+        // no locks or allocation, each packed message is unpacked in place
+        auto play = [this] (const int start, const int size)
+        {
+            for(int i = start; i < start + size; ++i)
             {
-                osc[message.getChannel()-1].get()->setAmplitude(0.0f);
+                const ScheduledEvent event { 0, auditionQueue[i].message };
+                playNote(VOICE_COUNT, AUDITION_VOICE_COUNT, MidiMessage(event.getStatus(), event.getData1(), event.getData2()), auditionQueue[i].row);
             }
+        };
+        
+        play(start1, size1);
+        play(start2, size2);
+        auditionFifo.finishedRead(size1 + size2);
+    }
+    
+    void Audio::playNote(int first, int count, const MidiMessage& message, int row)
+    {
+        const int channel = message.getChannel();
+        
+        // set the appropriate condition based on if note on or note off
+        if( message.isNoteOn() )
+        {
+            const int i = allocateVoice(first, count, channel, message.getNoteNumber());
+            voiceRow[i].set(row);
             
             // set frequency
             float freq = MidiMessage::getMidiNoteInHertz( message.getNoteNumber() );
-            osc[message.getChannel()-1].get()->setFrequency(freq);
+            osc[i].get()->setFrequency(freq);
+            osc[i].get()->setAmplitude( message.getFloatVelocity() );
+        }
+        else if( message.isNoteOff() )
+        {
+            // a note whose voice was stolen has nothing left to release
+            const int i = findVoice(first, count, channel, message.getNoteNumber());
+            if(i >= 0)
+            {
+                osc[i].get()->setAmplitude(0.0f);
+                voices[i].held = false;
+            }
         }
     }
     
+    int Audio::findVoice(int first, int count, int channel, int note) const
+    {
+        for(int i = first; i < first + count; ++i)
+            if(voices[i].held && voices[i].channel == channel && voices[i].note == note)
+                return i;
+        
+        return -1;
+    }
+    
+    int Audio::allocateVoice(int first, int count, int channel, int note)
+    {
+        // a note that is already sounding is retriggered on its own voice
+        int chosen = findVoice(first, count, channel, note);
+        
+        // otherwise released voices before held ones, the oldest of either first
+        if(chosen < 0)
+        {
+            chosen = first;
+            for(int i = first + 1; i < first + count; ++i)
+            {
+                const Voice& candidate = voices[i];
+                const Voice& best = voices[chosen];
+                
+                if(candidate.held != best.held ? best.held : candidate.age < best.age)
+                    chosen = i;
+            }
+        }
+        
+        voices[chosen] = { channel, note, true, ++noteOnCount };
+        return chosen;
+    }
+    
     //==========================================================================
     
     void Audio::linkAudioVisualiserComponent(std::shared_ptr<AudioVisualiserComponent> av)
@@ -130,33 +339,41 @@ namespace audio
     
     void Audio::setOscillator(int ID)
     {
+        oscillatorID.set(ID);
+        
         switch (ID) {
             case 1/*Sine*/:
-                for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+                for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
                 {
                     osc[i].set(&sine[i]);
                 }
                 break;
             case 2/*Square*/:
-                for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+                for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
                 {
                     osc[i].set(&square[i]);
                 }
                 break;
             case 3/*Saw*/:
-                for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+                for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
                 {
                     osc[i].set(&saw[i]);
                 }
                 break;
             case 4/*Triangle*/:
-                for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+                for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
                 {
                     osc[i].set(&triangle[i]);
                 }
                 break;
+            case 5/*Sampler*/:
+                for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
+                {
+                    osc[i].set(&sampler[i]);
+                }
+                break;
             default /*Sine*/:
-                for(int i = 0; i < MIDI_CHANNEL_TOTAL; ++i)
+                for(int i = 0; i < TOTAL_VOICE_COUNT; ++i)
                 {
                     osc[i].set(&sine[i]);
                 }
@@ -166,7 +383,109 @@ namespace audio
     
     void Audio::setFilterCutoff(float cutoff)
     {
-        filter.setCutoff(cutoff);
+        // picked up by the next audio callback
+        filterCutoff.set(cutoff);
+    }
+    
+    //==========================================================================
+    
+    void Audio::setStemRouting(bool shouldRenderStems)
+    {
+        stemRouting.set(shouldRenderStems);
+    }
+    
+    void Audio::setRowBus(int row, int outputChannel)
+    {
+        // the row is outside the grid!!!
+        jassert(row >= 0 && row < ROW_TOTAL);
+        // buses are one per output channel!!!
+        jassert(outputChannel >= 0 && outputChannel < MAX_OUTPUT_CHANNELS);
+        
+        rowBus[row & (ROW_TOTAL - 1)].set(outputChannel);
+    }
+    
+    AudioDeviceManager& Audio::getAudioDeviceManager()
+    {
+        return audioDeviceManager;
+    }
+    
+    void Audio::getSettings(ProjectSettings& settings) const
+    {
+        settings.oscillator = oscillatorID.get();
+        settings.filterCutoff = filterCutoff.get();
+        settings.stemRouting = stemRouting.get() ? 1 : 0;
+        
+        for(int i = 0; i < ROW_TOTAL; ++i)
+            settings.rowBus[i] = rowBus[i].get();
+    }
+    
+    void Audio::setSettings(const ProjectSettings& settings)
+    {
+        setOscillator(settings.oscillator);
+        setFilterCutoff(settings.filterCutoff);
+        setStemRouting(settings.stemRouting != 0);
+        
+        for(int i = 0; i < ROW_TOTAL; ++i)
+            setRowBus(i, jlimit(0, MAX_OUTPUT_CHANNELS - 1, (int)settings.rowBus[i]));
+    }
+    
+    void Audio::loadSamples(const File& directory)
+    {
+        Array<File> files = directory.findChildFiles(File::findFiles, false, "*.wav;*.aif;*.aiff");
+        files.sort();
+        
+        // retire the old samples, the audio thread may still be reading them
+        for(int i = 0; i < ROW_TOTAL; ++i)
+            rowStreams[i].set(nullptr);
+        
+        const uint32 retiredAt = callbackCount.get();
+        while(sampleStreams.size() > 0)
+        {
+            streamingThread.removeTimeSliceClient(sampleStreams.getLast());
+            retiredStreams.add({ sampleStreams.removeAndReturn(sampleStreams.size() - 1), retiredAt });
+        }
+        
+        reclaimStreams();
+        
+        // whatever is still in use is freed once the audio thread moves on
+        if(retiredStreams.size() > 0)
+            startTimer(100);
+        
+        // map each file onto the next row
+        for(int i = 0; i < jmin(files.size(), ROW_TOTAL); ++i)
+        {
+            auto* stream = sampleStreams.add(new synthesis::sampler::SampleStream(files[i]));
+            
+            if(stream->isValid())
+            {
+                streamingThread.addTimeSliceClient(stream);
+                rowStreams[i].set(stream);
+            }
+        }
+    }
+    
+    void Audio::reclaimStreams()
+    {
+        // the callback running as a sample was retired may finish with it,
+        // the one after that started without it
+        const uint32 now = callbackCount.get();
+        for(int i = retiredStreams.size(); --i >= 0;)
+        {
+            if(now - retiredStreams.getReference(i).callbackCount >= 2)
+            {
+                delete retiredStreams.getReference(i).stream;
+                retiredStreams.remove(i);
+            }
+        }
+    }
+    
+    void Audio::timerCallback()
+    {
+        reclaimStreams();
+        
+        // nothing left to free
+        if(retiredStreams.size() == 0)
+            stopTimer();
     }
     
 } //namespace audio
@@ -14,8 +14,10 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 #include "MidiOut.h"
+#include "ProjectFile.h"
 #include "../synthesis/Oscillator.h"
 #include "../synthesis/OscillatorTypes.h"
+#include "../synthesis/Sampler.h"
 #include "../synthesis/Filters.h"
 
 //==============================================================================
@@ -25,7 +27,7 @@ namespace audio
     /**
      * Handles MIDI input and audio output.
      */
-    class Audio : public AudioIODeviceCallback, public MidiInputCallback
+    class Audio : public AudioIODeviceCallback, public MidiInputCallback, private Timer
     {
     public:
         
@@ -63,7 +65,9 @@ namespace audio
         virtual void audioDeviceStopped() override;
         
         /**
-         * Callback function trigger for every midi message recieved.
+         * Callback function trigger for every midi message recieved. Each
+         * note on takes a voice from the pool, so any number of rows can
+         * share a channel, and plays the sample & bus of the row sending it.
          * 
          * @param source is the midi input source to be listened to.
          * @param message is the midi message recieved.
@@ -71,6 +75,24 @@ namespace audio
         virtual void handleIncomingMidiMessage (MidiInput* source,
                                                 const MidiMessage& message) override;
         
+        /**
+         * Starts a note on the internal synth straight from the interface,
+         * bypassing midi. Heard from the next audio block, playing or not.
+         * Message thread only.
+         * @param  row is the row auditioned, picking the sample & bus.
+         * @param  channel is the midi channel of the row.
+         * @param  note is the note number.
+         * @param  velocity is the note on velocity, 1 to 127.
+         */
+        void auditionNoteOn(int row, int channel, int note, uint8 velocity);
+        
+        /**
+         * Releases a note started with auditionNoteOn. Message thread only.
+         * @param  channel is the midi channel of the note.
+         * @param  note is the note number.
+         */
+        void auditionNoteOff(int channel, int note);
+        
         /**
          * Initialises the midi input device and starts the callback.
          * @param  The name of the midi input to be listened to.
@@ -90,31 +112,230 @@ namespace audio
         void setOscillator(int ID);
         
         /**
-         * Calls the LPF's co-efficent calculation function changing the cutoff.
+         * Changes the LPF cutoff, the filters are updated at the start of the
+         * next audio block.
          * @param  The new value for the cutoff frequency.
          */
         void setFilterCutoff(float cutoff);
         
+        /**
+         * Memory maps the audio files within a folder onto the sampler voices,
+         * assigned to each row in alphabetical order.
+         * @param  The folder holding the wav or aiff samples.
+         */
+        void loadSamples(const File& directory);
+        
+        /**
+         * Switches between a stereo mixdown and rendering each row to its bus.
+         * @param  true to render each row to its own output channel.
+         */
+        void setStemRouting(bool shouldRenderStems);
+        
+        /**
+         * Sets the bus a row is rendered to when stem routing, whichever
+         * channel & note the row is mapped onto.
+         * @param  row is the row to be routed.
+         * @param  outputChannel is the output channel of the bus.
+         */
+        void setRowBus(int row, int outputChannel);
+        
+        /**
+         * Accessor for the device manager, for choosing an interface.
+         * @return the audio device manager.
+         */
+        AudioDeviceManager& getAudioDeviceManager();
+        
+        /**
+         * Fills in the synthesiser fields of a project's settings.
+         * @param  the settings to be saved.
+         */
+        void getSettings(ProjectSettings& settings) const;
+        
+        /**
+         * Applies the synthesiser fields of a loaded project's settings.
+         * @param  the settings that were loaded.
+         */
+        void setSettings(const ProjectSettings& settings);
+        
+        /** Getter for the ID of the current oscillator bank. */
+        int getOscillator() const { return oscillatorID.get(); }
+        
+        /** Getter for the LPF cutoff frequency. */
+        float getFilterCutoff() const { return filterCutoff.get(); }
+        
+        /** Getter for whether each row is rendered to its own bus. */
+        bool getStemRouting() const { return stemRouting.get(); }
+    
     private:
+        /**
+         * Finds the voice playing a note.
+         * @param  first is the first voice of the pool searched.
+         * @param  count is the number of voices in the pool.
+         * @param  channel is the midi channel of the note.
+         * @param  note is the note number.
+         * @return the index of the voice, or -1 if the note isn't held.
+         */
+        int findVoice(int first, int count, int channel, int note) const;
+        
+        /**
+         * Takes a voice for a note, a voice already playing it first, then
+         * the voice released longest ago, then the oldest note is stolen.
+         * @param  first is the first voice of the pool to take from.
+         * @param  count is the number of voices in the pool.
+         * @param  channel is the midi channel of the note.
+         * @param  note is the note number.
+         * @return the index of the voice.
+         */
+        int allocateVoice(int first, int count, int channel, int note);
+        
+        /**
+         * Starts or releases a note on a voice of a pool.
+         * @param  first is the first voice of the pool.
+         * @param  count is the number of voices in the pool.
+         * @param  message is the note on or note off.
+         * @param  row is the row playing a note on, picking its sample & bus.
+         */
+        void playNote(int first, int count, const MidiMessage& message, int row);
+        
+        /**
+         * Queues an audition for the audio thread, dropped if the queue is full.
+         * @param  message is the note on or note off.
+         * @param  row is the row auditioned.
+         */
+        void pushAudition(const MidiMessage& message, int row);
+        
+        /**
+         * Plays every audition waiting in the queue. Audio thread only.
+         */
+        void processAuditions();
+        
+        /**
+         * Renders every voice into part of the output, no larger than the
+         * buffers allocated in audioDeviceAboutToStart. Audio thread only.
+         * @param  outputChannelData is the audio output of the whole block.
+         * @param  numOutputChannels is the number of audio output channels.
+         * @param  startSample is the first sample of the block to render.
+         * @param  numSamples is the number of samples to render.
+         */
+        void renderChunk(float** outputChannelData,
+                         int numOutputChannels,
+                         int startSample,
+                         int numSamples);
+        
+        /**
+         * Frees every retired sample the audio thread can no longer be
+         * reading, i.e. once a whole callback has run since it was replaced.
+         */
+        void reclaimStreams();
+        
+        /**
+         * Runs while samples are waiting to be freed, reclaiming them once
+         * the audio thread has moved on. Message thread only.
+         */
+        void timerCallback() override;
+        
         /** The audio device manager handling all ins & outs!*/
         AudioDeviceManager audioDeviceManager;
         
         /** No of midi channels avaliable. */
         static const int MIDI_CHANNEL_TOTAL = 16;
+        /** Rows with their own sample & bus, every row a grid can have. */
+        static const int ROW_TOTAL = Pattern::MAX_ROWS;
+        /** Most output channels (buses) opened on the interface. */
+        static const int MAX_OUTPUT_CHANNELS = 32;
+        /** Most notes played at once, voices are shared by every channel. */
+        static const int VOICE_COUNT = 16;
+        /** Voices kept for auditioning after the sequencer's, audio thread only. */
+        static const int AUDITION_VOICE_COUNT = 4;
+        /** Every voice, the sequencer's then the audition voices. */
+        static const int TOTAL_VOICE_COUNT = VOICE_COUNT + AUDITION_VOICE_COUNT;
+        /** Most auditions waiting for the next audio block. */
+        static const int AUDITION_QUEUE_SIZE = 64;
         /** Pointer for oscillators - demonstrating polymorphism. */
-        Atomic<synthesis::osc::Oscillator*> osc[MIDI_CHANNEL_TOTAL];
+        Atomic<synthesis::osc::Oscillator*> osc[TOTAL_VOICE_COUNT];
+        /** The ID of the current oscillator bank. */
+        Atomic<int> oscillatorID;
+        /** The current LPF cutoff frequency. */
+        Atomic<float> filterCutoff;
+        /** The cutoff the filters were last set to, audio thread only. */
+        float appliedCutoff;
         
         /** Bank of sine oscillators. */
-        synthesis::osc::Sine sine[MIDI_CHANNEL_TOTAL];
+        synthesis::osc::Sine sine[TOTAL_VOICE_COUNT];
         /** Bank of square wave oscillators.*/
-        synthesis::osc::Square square[MIDI_CHANNEL_TOTAL];
+        synthesis::osc::Square square[TOTAL_VOICE_COUNT];
         /** Bank of saw wave oscillators.*/
-        synthesis::osc::Saw saw[MIDI_CHANNEL_TOTAL];
+        synthesis::osc::Saw saw[TOTAL_VOICE_COUNT];
         /** Bank of triangle wave oscillators.*/
-        synthesis::osc::Triangle triangle[MIDI_CHANNEL_TOTAL];
+        synthesis::osc::Triangle triangle[TOTAL_VOICE_COUNT];
+        /** Bank of sample playback voices.*/
+        synthesis::osc::Sampler sampler[TOTAL_VOICE_COUNT];
+        
+        /** The note a voice is playing. */
+        struct Voice
+        {
+            /** The midi channel of the note. */
+            int channel;
+            /** The note number. */
+            int note;
+            /** True until the note is released. */
+            bool held;
+            /** When the voice was last taken, counted in note ons. */
+            uint32 age;
+        };
+        
+        /** The note of each voice, sequencer voices on the midi thread & audition voices on the audio thread. */
+        Voice voices[TOTAL_VOICE_COUNT];
+        /** Counts note ons, to find the oldest voice. */
+        Atomic<uint32> noteOnCount;
+        /** The row each voice last played, picking its sample & bus. */
+        Atomic<int> voiceRow[TOTAL_VOICE_COUNT];
+        
+        /** Single producer, single consumer indices into the audition queue. */
+        AbstractFifo auditionFifo;
+        /** A note waiting to be auditioned. */
+        struct Audition
+        {
+            /** The note on or off, packed as a ScheduledEvent message. */
+            uint32 message;
+            /** The row auditioned. */
+            int row;
+        };
+        
+        /** Auditions waiting for the next audio block. */
+        Audition auditionQueue[AUDITION_QUEUE_SIZE];
+        
+        /** Background thread paging in samples ahead of each voice. */
+        TimeSliceThread streamingThread;
+        /** The samples currently mapped onto the sampler voices. */
+        OwnedArray<synthesis::sampler::SampleStream> sampleStreams;
+        /** The sample each row plays, handed to its voices by the audio thread. */
+        Atomic<synthesis::sampler::SampleStream*> rowStreams[ROW_TOTAL];
+        /** A replaced sample waiting to be freed. */
+        struct RetiredStream
+        {
+            /** The replaced sample. */
+            synthesis::sampler::SampleStream* stream;
+            /** The callback count when it was replaced. */
+            uint32 callbackCount;
+        };
+        
+        /** Replaced samples, kept alive as the audio thread may still be reading. */
+        Array<RetiredStream> retiredStreams;
+        /** Audio callbacks completed, to tell when a retired sample is unreachable. */
+        Atomic<uint32> callbackCount;
+        
+        /** A simple one pole LPF for each bus.*/
+        synthesis::filter::OnePole filter[MAX_OUTPUT_CHANNELS];
         
-        /** A simple one pole LPF.*/
-        synthesis::filter::OnePole filter;
+        /** True when each row is rendered to its own bus. */
+        Atomic<bool> stemRouting;
+        /** The bus (output channel) each row is rendered to as a stem. */
+        Atomic<int> rowBus[ROW_TOTAL];
+        /** Each bus summed for the current block. */
+        AudioBuffer<float> busBuffer;
+        /** A single voice rendered for the current block. */
+        AudioBuffer<float> voiceBuffer;
         
         /** A reference to the visualiser for the audio. */
         std::shared_ptr<AudioVisualiserComponent> visualiser;
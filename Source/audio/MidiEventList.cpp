@@ -15,50 +15,406 @@ namespace audio
     MidiEventList::MidiEventList()
     {
         eventList.clear(); // ensure list is empty
+        
+        startNote = 60;
+        velocity = 90;
+        noteMode = retrigger;
+        
+        for(int row = 0; row < Pattern::MAX_ROWS; ++row)
+        {
+            rowTargets[row] = RowTarget::getDefault(row);
+            rowTimings[row] = { 0, 1 };
+        }
+        
+        ticksPerStep = MusicalClock::DEFAULT_PPQ / MusicalClock::STEPS_PER_BEAT;
+        swingTicks = 0;
+        hasRowTiming = false;
+        changed = true;
     }
     
     MidiEventList::~MidiEventList(){}
     
+    //==========================================================================
+    
+    void MidiEventList::setGridSize(const int rows, const int columns)
+    {
+        pattern.setSize(rows, columns);
+        changed = true;
+    }
+    
+    void MidiEventList::setStepNotes(const int startNoteParam,
+                                     const uint8 velocityParam)
+    {
+        if(startNote != startNoteParam || velocity != velocityParam)
+        {
+            startNote = startNoteParam;
+            velocity = velocityParam;
+            changed = true;
+        }
+    }
+    
+    void MidiEventList::setRowTarget(const int row, const RowTarget target)
+    {
+        // the row you are mapping is out of range!!!
+        jassert(row >= 0 && row < Pattern::MAX_ROWS);
+        // midi channels are 1 to 16!!!
+        jassert(target.channel >= 1 && target.channel <= 16);
+        
+        RowTarget& current = rowTargets[row & (Pattern::MAX_ROWS - 1)];
+        const RowTarget mapped { (uint8)jlimit(1, 16, (int)target.channel), (int16)jlimit(-1, 127, (int)target.note) };
+        
+        if(current.channel != mapped.channel || current.note != mapped.note)
+        {
+            current = mapped;
+            changed = true;
+        }
+    }
+    
+    void MidiEventList::setNoteMode(const NoteMode mode)
+    {
+        if(noteMode != mode)
+        {
+            noteMode = mode;
+            changed = true;
+        }
+    }
+    
+    void MidiEventList::setTicksPerStep(const int ticks)
+    {
+        // steps must be at least a tick long!!!
+        jassert(ticks > 0);
+        
+        if(ticksPerStep != ticks)
+        {
+            // swing & row offsets keep their feel at the new resolution
+            const int previous = ticksPerStep;
+            ticksPerStep = jmax(1, ticks);
+            swingTicks = swingTicks * ticksPerStep / previous;
+            for(int row = 0; row < Pattern::MAX_ROWS; ++row)
+                rowTimings[row].offset = (int16)(rowTimings[row].offset * ticksPerStep / previous);
+            
+            changed = true;
+        }
+    }
+    
+    void MidiEventList::setSwing(const float amount)
+    {
+        const int ticks = roundToInt(jlimit(0.0f, 0.75f, amount) * ticksPerStep);
+        
+        if(swingTicks != ticks)
+        {
+            swingTicks = ticks;
+            changed = true;
+        }
+    }
+    
+    void MidiEventList::setRowTiming(const int row, const RowTiming timing)
+    {
+        // the row you are timing is out of range!!!
+        jassert(row >= 0 && row < Pattern::MAX_ROWS);
+        
+        RowTiming& current = rowTimings[row & (Pattern::MAX_ROWS - 1)];
+        const int limit = ticksPerStep / 2;
+        const RowTiming clamped { (int16)jlimit(-limit, limit, (int)timing.offset), (uint8)jlimit(1, 8, (int)timing.ratchets) };
+        
+        if(current.offset != clamped.offset || current.ratchets != clamped.ratchets)
+        {
+            current = clamped;
+            
+            hasRowTiming = false;
+            for(auto& rowTiming : rowTimings)
+                hasRowTiming = hasRowTiming || rowTiming.offset != 0 || rowTiming.ratchets > 1;
+            
+            changed = true;
+        }
+    }
+    
+    void MidiEventList::setStep(const int row, const int column, const bool state)
+    {
+        pattern.setStep(row, column, state);
+        changed = true;
+    }
+    
+    bool MidiEventList::getStep(const int row, const int column) const
+    {
+        return pattern.getStep(row, column);
+    }
+    
+    MidiMessage MidiEventList::getStepEvent(const int row, const int column, const bool isNoteOn) const
+    {
+        const int offset = rowTimings[row & (Pattern::MAX_ROWS - 1)].offset;
+        return getRowEvent(row, getStepTick(isNoteOn ? column : column + 1) + offset, isNoteOn);
+    }
+    
+    void MidiEventList::setSteps(const StepMask* source, const int stepCount)
+    {
+        pattern.copyFrom(source, stepCount);
+        changed = true;
+    }
+    
+    //==========================================================================
+    
     void MidiEventList::addMidiEvent(const MidiMessage& midiMessage)
     {
-            eventList.add(midiMessage);
-            eventList.sort(sorter); // sort by timestamp
+        // binary insertion keeps the list sorted by timestamp
+        eventList.insert(getInsertIndex(midiMessage), midiMessage);
+        changed = true;
     }
     
     void MidiEventList::removeMidiEvent(const MidiMessage& midiMessage)
     {
-        for(int i = 0; i < eventList.size(); i++)
+        // only events sharing the time stamp can match
+        for(int i = getInsertIndex(midiMessage) - 1; i >= 0; i--)
         {
-            if(eventList[i] == midiMessage)
+            const MidiMessage& event = eventList.getReference(i);
+            
+            if(sorter.compareElements(event, midiMessage) != 0)
+                break; // passed all candidates
+            
+            if(event == midiMessage)
             {
                 eventList.remove(i);
+                changed = true;
                 break;  // leave the list
             }
         }
+    }
+    
+    void MidiEventList::removeMidiEvent(const int index)
+    {
+        // the origins must match the list the index was read from
+        updateEvents();
+        
+        // the index you are removing is out of range!!!
+        jassert(index >= 0 && index < mergedOrigin.size());
+        if(index < 0 || index >= mergedOrigin.size())
+            return;
+        
+        const int origin = mergedOrigin[index];
+        
+        if(origin >= 0)
+            eventList.remove(origin);
+        else
+            pattern.setStep((-origin - 1) % Pattern::MAX_ROWS, (-origin - 1) / Pattern::MAX_ROWS, false);
         
-        eventList.sort(sorter); // sort by timestamp
+        changed = true;
+    }
+    
+    int MidiEventList::getFirstIndexAt(const double timeStamp) const
+    {
+        updateEvents();
+        
+        int low = 0;
+        int high = mergedList.size();
+        
+        // lower bound of the time stamp
+        while(low < high)
+        {
+            const int mid = (low + high) / 2;
+            
+            if(mergedList.getReference(mid).getTimeStamp() < timeStamp)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        
+        return low;
     }
     
     MidiMessage MidiEventList::getMidiEvent(const int index) const
     {
+        updateEvents();
+        
         // the index you are getitng is out of range!!!
         jassert(index < getSize());
         
-        return eventList[index];
+        return mergedList[index];
     }
     
-    void MidiEventList::setMidiEvent(const int index,
-                                     const MidiMessage& midiMessage)
+    int MidiEventList::getSize() const
     {
-        // the index you want to set is out of range!!!
-        jassert(index < getSize());
+        updateEvents();
         
-        eventList.set(index, midiMessage);
+        return mergedList.size();
     }
     
-    int MidiEventList::getSize() const
+    //==========================================================================
+    
+    int MidiEventList::getInsertIndex(const MidiMessage& midiMessage) const
     {
-        return eventList.size();
+        int low = 0;
+        int high = eventList.size();
+        
+        // upper bound, so equivalent events keep the order they were added
+        while(low < high)
+        {
+            const int mid = (low + high) / 2;
+            
+            if(sorter.compareElements(midiMessage, eventList.getReference(mid)) < 0)
+                high = mid;
+            else
+                low = mid + 1;
+        }
+        
+        return low;
+    }
+    
+    int MidiEventList::getStepTick(const int column) const
+    {
+        // odd columns are the off beats
+        return column * ticksPerStep + ((column & 1) != 0 ? swingTicks : 0);
+    }
+    
+    MidiMessage MidiEventList::getRowEvent(const int row, const int tick, const bool isNoteOn) const
+    {
+        // a table lookup, however many rows there are
+        const RowTarget& target = rowTargets[row & (Pattern::MAX_ROWS - 1)];
+        const int note = jlimit(0, 127, target.note >= 0 ? (int)target.note : startNote + row);
+        
+        MidiMessage event = isNoteOn ? MidiMessage::noteOn(target.channel, note, velocity)
+                                     : MidiMessage::noteOff(target.channel, note, (uint8)0);
+        
+        // an offset row can't play before the loop starts or after it ends, a
+        // note on is kept off the loop end so its note off still sorts after it
+        const int loopEnd = pattern.getNumSteps() * ticksPerStep;
+        event.setTimeStamp(isNoteOn ? jlimit(0, jmax(0, loopEnd - 1), tick)
+                                    : jlimit(jmin(1, loopEnd), loopEnd, tick));
+        return event;
+    }
+    
+    void MidiEventList::updateEvents() const
+    {
+        if(changed == false)
+            return;
+        
+        mergedList.clearQuick();
+        mergedOrigin.clearQuick();
+        int added = 0;
+        
+        // added events sorting before a time stamp
+        auto addEventsBefore = [this, &added] (const double time)
+        {
+            while(added < eventList.size()
+                  && eventList.getReference(added).getTimeStamp() < time)
+            {
+                mergedList.add(eventList.getReference(added));
+                mergedOrigin.add(added++);
+            }
+        };
+        
+        const bool isLegato = noteMode == legato;
+        
+        // a note on or off for each row of a mask on a column
+        auto addStepEvents = [this, isLegato] (const int column, const StepMask& rows, const bool isNoteOn)
+        {
+            Pattern::forEachRowIn(rows, [&] (const int row)
+            {
+                const int origin = -(column * Pattern::MAX_ROWS + row) - 1;
+                const int ratchets = isLegato ? 1 : rowTimings[row].ratchets;
+                
+                // a ratcheted step is split evenly, every note but the last ends within the step
+                if(isNoteOn && ratchets > 1)
+                {
+                    const int start = getStepTick(column) + rowTimings[row].offset;
+                    const int length = getStepTick(column + 1) - getStepTick(column);
+                    const int loopEnd = pattern.getNumSteps() * ticksPerStep;
+                    
+                    for(int i = 0; i < ratchets; ++i)
+                    {
+                        // a ratchet is the last once the next would start after the loop, the step's note off ends it
+                        const int end = start + length * (i + 1) / ratchets;
+                        const bool isLast = i + 1 == ratchets || end >= loopEnd;
+                        
+                        // ratchets wholly before the loop starts are dropped
+                        if(end <= 0 && isLast == false)
+                            continue;
+                        
+                        mergedList.add(getRowEvent(row, start + length * i / ratchets, true));
+                        mergedOrigin.add(origin);
+                        
+                        if(isLast)
+                            break;
+                        
+                        mergedList.add(getRowEvent(row, end, false));
+                        mergedOrigin.add(origin);
+                    }
+                    return;
+                }
+                
+                mergedList.add(getStepEvent(row, column, isNoteOn));
+                mergedOrigin.add(origin);
+            });
+        };
+        
+        // rows in a but not in b
+        auto without = [] (const StepMask& a, const StepMask& b)
+        {
+            return StepMask { { a.bits[0] & ~b.bits[0], a.bits[1] & ~b.bits[1] } };
+        };
+        
+        // only columns with a step on are visited, empty ones are skipped
+        int previous = -1;
+        for(int column = pattern.findNextActiveStep(0);
+            column < pattern.getNumSteps();
+            column = pattern.findNextActiveStep(column + 1))
+        {
+            const StepMask& steps = pattern.getStepMask(column);
+            const bool follows = isLegato && previous == column - 1;
+            
+            // notes from the last active column end first, unless legato carries them on...
+            if(previous >= 0)
+            {
+                const StepMask& previousSteps = pattern.getStepMask(previous);
+                addEventsBefore(getStepTick(previous + 1));
+                addStepEvents(previous, follows ? without(previousSteps, steps) : previousSteps, false);
+            }
+            
+            // ...then added events sorting before this step...
+            addEventsBefore(getStepTick(column));
+            
+            // ...before notes starting on it
+            addStepEvents(column, follows ? without(steps, pattern.getStepMask(previous)) : steps, true);
+            previous = column;
+        }
+        
+        if(previous >= 0)
+        {
+            addEventsBefore(getStepTick(previous + 1));
+            addStepEvents(previous, pattern.getStepMask(previous), false);
+        }
+        
+        // anything added after the last step
+        addEventsBefore(std::numeric_limits<double>::infinity());
+        
+        // offset rows & ratchets can cross other rows' events, so only then is a sort needed
+        if(hasRowTiming)
+        {
+            Array<int> order;
+            order.ensureStorageAllocated(mergedList.size());
+            for(int i = 0; i < mergedList.size(); ++i)
+                order.add(i);
+            
+            // stable, so events sharing a time stamp keep the order they were visited in
+            std::stable_sort(order.begin(), order.end(), [this] (const int lhs, const int rhs)
+            {
+                return sorter.compareElements(mergedList.getReference(lhs), mergedList.getReference(rhs)) < 0;
+            });
+            
+            Array<MidiMessage> sortedList;
+            Array<int> sortedOrigin;
+            sortedList.ensureStorageAllocated(mergedList.size());
+            sortedOrigin.ensureStorageAllocated(mergedList.size());
+            for(const int i : order)
+            {
+                sortedList.add(mergedList.getReference(i));
+                sortedOrigin.add(mergedOrigin[i]);
+            }
+            
+            mergedList.swapWith(sortedList);
+            mergedOrigin.swapWith(sortedOrigin);
+        }
+        
+        changed = false;
     }
     
 } //namespace audio
@@ -14,6 +14,8 @@
 #pragma once
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "Pattern.h"
+#include "MusicalClock.h"
 
 //==============================================================================
 
@@ -32,30 +34,79 @@ namespace audio
     {
     public:
         /**
-         *  Returns a value determining what time stamp is larger.
+         *  Returns a value determining what time stamp is larger. Note offs
+         *  are placed before anything else sharing their time stamp so a
+         *  note ending on a step never cuts off the next note starting.
          *  @param  lhs is the leftmost message to be compared.
          *  @param  rhs is the rightmost message to be compared.
          *  @return if the element is bigger, smaller or the same as/
          */
-        static int compareElements(MidiMessage lhs, MidiMessage rhs)
+        static int compareElements(const MidiMessage& lhs, const MidiMessage& rhs)
         {
             if (lhs.getTimeStamp() < rhs.getTimeStamp())
                 return -1;
             else if (lhs.getTimeStamp() > rhs.getTimeStamp())
                 return 1;
+            else if (lhs.isNoteOff() && rhs.isNoteOff() == false)
+                return -1;
+            else if (lhs.isNoteOff() == false && rhs.isNoteOff())
+                return 1;
             else // if a == b
                 return 0;
         }
     };
-
+    
+    //==========================================================================
+    
+    /**
+     *  Where the notes of a row are sent. Rows can share a channel, so a
+     *  grid is never limited by the 16 channels of midi.
+     */
+    struct RowTarget
+    {
+        /** The midi channel, 1 to 16. */
+        uint8 channel;
+        /** The note number, or -1 to play the start note + the row. */
+        int16 note;
+        
+        /**
+         *  The target a row has until it is mapped, its own channel while
+         *  there are channels to go round.
+         *  @param the row index.
+         *  @return channel (row % 16) + 1, playing the start note + the row.
+         */
+        static RowTarget getDefault(const int row) { return { (uint8)(row % 16 + 1), -1 }; }
+    };
+    
     //==========================================================================
     
     /**
-     *  Container for midi messages sorted by there timecode.
+     *  When the steps of a row play, relative to the grid.
+     */
+    struct RowTiming
+    {
+        /** Ticks the row plays late, or early if negative, within half a step. */
+        int16 offset;
+        /** The notes each step is split into, 1 to 8. */
+        uint8 ratchets;
+    };
+    
+    //==========================================================================
+    
+    /**
+     *  Container for midi messages sorted by there timecode. Sequencer steps
+     *  are held in a bitset Pattern so toggling one is O(1), their note
+     *  messages are only built when the list is next read.
      */
     class MidiEventList
     {
     public:
+        /** How the steps of a row are turned into notes. */
+        enum NoteMode
+        {
+            retrigger = 0,  ///< every step is its own note
+            legato          ///< a run of adjacent steps is one long note
+        };
         
         /**
          * Constructor. Clears the array.
@@ -66,42 +117,208 @@ namespace audio
         ~MidiEventList();
         
         /**
-         *  Adds the input midi event so long as not already in list. 
-         *  @param The midi message to be added to the list.
+         *  Resizes the step grid, clearing every step.
+         *  @param rows is the number of rows (notes) in the grid.
+         *  @param columns is the number of steps in each row.
+         */
+        void setGridSize(const int rows, const int columns);
+        
+        /**
+         *  Sets the notes built for each step. Row n plays startNote + n
+         *  unless it is mapped onto a note of its own.
+         *  @param startNote is the note number of the bottom row.
+         *  @param velocity is the velocity of every step.
+         */
+        void setStepNotes(const int startNote, const uint8 velocity);
+        
+        /**
+         *  Maps a row onto a midi channel & note.
+         *  @param row is the row index.
+         *  @param target is the channel & note the row's steps are sent to.
+         */
+        void setRowTarget(const int row, const RowTarget target);
+        
+        /**
+         *  Sets how steps are turned into notes. Legato halves the messages
+         *  of a dense row & never retriggers a note that is already held.
+         *  @param the note mode.
+         */
+        void setNoteMode(const NoteMode mode);
+        
+        /** Getter for how steps are turned into notes. */
+        NoteMode getNoteMode() const { return noteMode; }
+        
+        /**
+         *  Sets the resolution of the time line, steps are placed on it in
+         *  whole ticks so swing & microtiming cost nothing to play.
+         *  @param the ticks in each sequencer step.
+         */
+        void setTicksPerStep(const int ticks);
+        
+        /** Getter for the ticks in each sequencer step. */
+        int getTicksPerStep() const { return ticksPerStep; }
+        
+        /**
+         *  Delays every other step, the second sixteenth of each eighth.
+         *  @param the fraction of a step the off beats are delayed, 0 to 0.75.
+         */
+        void setSwing(const float amount);
+        
+        /**
+         *  Nudges a row off the grid or splits its steps into ratchets.
+         *  Ratchets only apply when steps are retriggered.
+         *  @param row is the row index.
+         *  @param timing is the offset & ratchets of the row.
+         */
+        void setRowTiming(const int row, const RowTiming timing);
+        
+        /**
+         *  Getter for the timing of a row.
+         *  @param the row index.
+         *  @return the offset & ratchets of the row.
+         */
+        RowTiming getRowTiming(const int row) const { return rowTimings[row & (Pattern::MAX_ROWS - 1)]; }
+        
+        /**
+         *  Turns a step on or off. O(1), no messages are built or compared.
+         *  @param row is the row index of the step.
+         *  @param column is the column index of the step.
+         *  @param state is true for an active step.
+         */
+        void setStep(const int row, const int column, const bool state);
+        
+        /**
+         *  Returns the state of a step.
+         *  @param row is the row index of the step.
+         *  @param column is the column index of the step.
+         *  @return true if the step is active.
+         */
+        bool getStep(const int row, const int column) const;
+        
+        /**
+         *  Builds the note on or note off of a single step, as it is compiled
+         *  when steps are retriggered and the row isn't ratcheted.
+         *  @param row is the row index of the step.
+         *  @param column is the column index of the step.
+         *  @param isNoteOn is true for the note on, false for the note off.
+         *  @return the message, time stamped in ticks.
+         */
+        MidiMessage getStepEvent(const int row, const int column, const bool isNoteOn) const;
+        
+        /**
+         *  Accessor for the step grid.
+         *  @return the pattern of active steps.
+         */
+        const Pattern& getPattern() const { return pattern; }
+        
+        /**
+         *  Copies every step in as a block, for loading.
+         *  @param source is the first of the step masks to be copied.
+         *  @param stepCount is the number of step masks at source.
+         */
+        void setSteps(const StepMask* source, const int stepCount);
+        
+        /**
+         *  Inserts the midi event in time stamp order, after any equivalent
+         *  events, using a binary search. O(log n) compares.
+         *  @param The midi message to be added to the list, time stamped in ticks.
          */
         void addMidiEvent(const MidiMessage& midiMessage);
         
         /**
-         * Removes the first appearence of the midi event input.
+         * Removes the first appearence of the midi event input. Only the
+         * events sharing its time stamp are compared.
          * @param The midi message to be removed from the list.
          */
         void removeMidiEvent(const MidiMessage& midiMessage);
         
         /**
-         *  Returns the event at the index passed of the list.
-         *  @param The index of the midi valude ot be found.
+         * Removes the event at the index passed, the list stays sorted.
+         * Removing a step's note on or off turns that step off.
+         * @param The index of the midi event to be removed.
          */
-        MidiMessage getMidiEvent(const int index) const;
+        void removeMidiEvent(const int index);
         
         /**
-         *  Setter for a specfic index of the event list.
-         *  @param The index of the midi value to be found.
-         *  @param The new midi message for that index.
+         * Finds the first event at or after a time stamp.
+         * @param The time stamp to search for.
+         * @return the index of that event, or the size if there is none.
          */
-        void setMidiEvent(const int index, const MidiMessage& midiMessage);
+        int getFirstIndexAt(const double timeStamp) const;
+        
+        /**
+         *  Returns the event at the index passed of the list.
+         *  @param The index of the midi valude ot be found.
+         */
+        MidiMessage getMidiEvent(const int index) const;
         
         /**
          *  Returns the size of the event list.
          *  @return size of the event list.
          */
         int getSize() const;
-                        
+    
     private:
         
-        /** Array holding all scheduled midi messages. */
+        /**
+         *  Finds where a message belongs, after any equivalent events.
+         *  @param The midi message to be placed.
+         *  @return the index the message should be inserted at.
+         */
+        int getInsertIndex(const MidiMessage& midiMessage) const;
+        
+        /**
+         *  Finds where a column starts on the time line, off beats are swung.
+         *  @param the column index, up to the number of steps.
+         *  @return the tick the column starts on.
+         */
+        int getStepTick(const int column) const;
+        
+        /**
+         *  Builds a note on or off of a row.
+         *  @param row is the row index.
+         *  @param tick is the time stamp, kept within the pattern.
+         *  @param isNoteOn is true for a note on, false for a note off.
+         *  @return the message.
+         */
+        MidiMessage getRowEvent(const int row, const int tick, const bool isNoteOn) const;
+        
+        /**
+         *  Rebuilds the sorted list if any step or event has changed, visiting
+         *  only the active steps in time order so no sort is needed.
+         */
+        void updateEvents() const;
+        
+        /** Array holding the events added with addMidiEvent. */
         Array<MidiMessage> eventList;
         /** Our sorter object for the array. */
         MidiMessageTimestampSorter sorter;
+        
+        /** The step grid, one bit per (row, column). */
+        Pattern pattern;
+        /** The note number of the bottom row. */
+        int startNote;
+        /** The velocity of each step. */
+        uint8 velocity;
+        /** How steps are turned into notes. */
+        NoteMode noteMode;
+        /** The channel & note of each row. */
+        RowTarget rowTargets[Pattern::MAX_ROWS];
+        /** The ticks in each sequencer step. */
+        int ticksPerStep;
+        /** The ticks every other step is delayed. */
+        int swingTicks;
+        /** The offset & ratchets of each row. */
+        RowTiming rowTimings[Pattern::MAX_ROWS];
+        /** Set when any row is off the grid, so step events can cross. */
+        bool hasRowTiming;
+        
+        /** Steps and added events merged in time stamp order. */
+        mutable Array<MidiMessage> mergedList;
+        /** Where each merged event came from, an added event index or -(cell + 1). */
+        mutable Array<int> mergedOrigin;
+        /** Set when the merged list needs to be rebuilt. */
+        mutable bool changed;
     };
     
     //==========================================================================
@@ -12,22 +12,30 @@
 
 namespace audio
 {
-    MidiOut::MidiOut()
+    MidiOut::MidiOut() : sequencer(juce::MidiOutput::createNewDevice("step-sequencer")) // create our midi output interface
     {
-        // create our midi output interface
-        midiOutput = juce::MidiOutput::createNewDevice("step-sequencer");
+        editTrack = sequencer.addTrack();
+        editPattern = 0;
+        sequencer.addListener(this);
         
         // initalise default playback settings
-        setPlayback("tempo", 120.0f);
-        setPlayback("velocity", 90.0f);
-        preparePlayback();
-        setPlayback("startnote", 60.0f);
-        isPlaying.set(false);
+        playbackSettings.addListener(PlaybackSettings::tempo, this);
+        playbackSettings.addListener(PlaybackSettings::velocity, this);
+        playbackSettings.addListener(PlaybackSettings::startNote, this);
+        playbackSettings.addListener(PlaybackSettings::noteMode, this);
+        playbackSettings.addListener(PlaybackSettings::swing, this);
+        playbackSettings.addListener(PlaybackSettings::compactOutput, this);
+        setPlayback(PlaybackSettings::tempo, 120.0f);
+        setPlayback(PlaybackSettings::velocity, 90.0f);
+        setPlayback(PlaybackSettings::startNote, 60.0f);
     }
     
     MidiOut::~MidiOut()
     {
-        midiOutput->clearAllPendingMessages();
+        // the clock is joined before the listener it could call is cleared
+        sequencer.stop();
+        sequencer.addListener(nullptr);
+        cancelPendingUpdate();
     }
     
     MidiOut& MidiOut::getInstance()
@@ -38,82 +46,242 @@ namespace audio
     
     //==========================================================================
     
-    void MidiOut::setPlayback (String setting, float value)
+    void MidiOut::setPlayback (const PlaybackSettings::Setting setting, const float value)
     {
-        playbackSettings.set(setting.toLowerCase().removeCharacters(" "),
-                              value);
+        playbackSettings.set(setting, value);
     }
     
-    float MidiOut::getSetting (String setting) const
+    void MidiOut::setLookahead (const int milliseconds)
     {
-        setting = setting.toLowerCase().removeCharacters(" ");
+        sequencer.setLookahead(milliseconds);
+    }
+    
+    void MidiOut::setPpq (const int ticksPerQuarterNote)
+    {
+        sequencer.setPpq(ticksPerQuarterNote);
+    }
+    
+    MidiEventList::NoteMode MidiOut::getNoteMode() const
+    {
+        return getSetting(PlaybackSettings::noteMode) >= 0.5f ? MidiEventList::legato : MidiEventList::retrigger;
+    }
+    
+    int MidiOut::openOutputDevice(const String& deviceIdentifier)
+    {
+        const int index = sequencer.addPort(juce::MidiOutput::openDevice(deviceIdentifier));
         
-        // The setting you were looking for does not exist!!!
-        jassert(playbackSettings.contains(setting));
+        // a new port sends the same encoding as the others
+        if(index >= 0)
+            sequencer.getPort(index).setCompact(getSetting(PlaybackSettings::compactOutput) >= 0.5f);
         
-        return playbackSettings[setting];
+        return index;
     }
     
-    //==========================================================================
+    int MidiOut::addTrack()
+    {
+        const int index = sequencer.addTrack();
+        Song& song = sequencer.getTrack(index).getSong();
+        
+        song.setGridSize((int)getSetting(PlaybackSettings::rowCount), (int)getSetting(PlaybackSettings::columnCount));
+        song.setStepNotes((int)getSetting(PlaybackSettings::startNote), (uint8)getSetting(PlaybackSettings::velocity));
+        song.setNoteMode(getNoteMode());
+        song.setSwing(getSetting(PlaybackSettings::swing));
+        sequencer.getTrack(index).setVelocity(jlimit(1, 127, (int)getSetting(PlaybackSettings::velocity)));
+        
+        return index;
+    }
     
-    void MidiOut::cartesianToggleChanged(const bool state,
-                                         const int x,
-                                         const int y)
+    void MidiOut::setEditTrack(const int index)
     {
-        const int& row = y;
-        const int& column = x;
+        editTrack = index;
+        editPattern = 0;
+        history.reset(getSong().getPattern(editPattern));
         
-        // calculate the note value for each step
-        const int noteNumber = playbackSettings["startnote"] + row;
+        if(listener != nullptr)
+            listener->patternChanged();
+    }
+    
+    void MidiOut::setGridSize (const int rowCount, const int columnCount)
+    {
+        setPlayback(PlaybackSettings::rowCount, rowCount);
+        setPlayback(PlaybackSettings::columnCount, columnCount);
         
-        // place converted values into a midi message
-        MidiMessage newMessageOn = MidiMessage::noteOn((row+1),
-                                                       noteNumber,
-                                                       (uint8)playbackSettings["velocity"]);
-        newMessageOn.addToTimeStamp(/*increment */ column);
+        for(int i = 0; i < sequencer.getNumTracks(); ++i)
+            sequencer.getTrack(i).getSong().setGridSize(rowCount, columnCount);
         
-        MidiMessage newMessageOff = MidiMessage::noteOff((row+1),
-                                                         noteNumber,
-                                                         (uint8)0);
-        newMessageOff.addToTimeStamp(/*increment */ (column+1));
+        history.reset(getSong().getPattern(editPattern));
+    }
+    
+    bool MidiOut::getStep (const int row, const int column) const
+    {
+        return getSong().getStep(editPattern, row, column);
+    }
+    
+    void MidiOut::getSettings(ProjectSettings& settings) const
+    {
+        settings.tempo = getSetting(PlaybackSettings::tempo);
+        settings.velocity = getSetting(PlaybackSettings::velocity);
+        settings.startNote = (int32)getSetting(PlaybackSettings::startNote);
+        settings.compactOutput = getSetting(PlaybackSettings::compactOutput) >= 0.5f ? 1 : 0;
+    }
+    
+    void MidiOut::loadProject(const ProjectFile& project)
+    {
+        // the project was not mapped!!!
+        jassert(project.isValid());
         
-        // modify the event list
-        if(state == true)
-        {
-            eventList.addMidiEvent(newMessageOn);
-            eventList.addMidiEvent(newMessageOff);
-        }
-        else
-        {
-            // as all values are gaurenteed to be unique on a grid we can...
-            eventList.removeMidiEvent(newMessageOn);
-            eventList.removeMidiEvent(newMessageOff);
-        }
+        const ProjectHeader& header = project.getHeader();
+        const ProjectSettings settings = project.getSettings();
+        
+        setPlayback(PlaybackSettings::tempo, settings.tempo);
+        setPlayback(PlaybackSettings::velocity, settings.velocity);
+        setPlayback(PlaybackSettings::startNote, (float)settings.startNote);
+        setPlayback(PlaybackSettings::noteMode, header.noteMode == (uint32)MidiEventList::legato ? 1.0f : 0.0f);
+        setPlayback(PlaybackSettings::compactOutput, settings.compactOutput != 0 ? 1.0f : 0.0f);
+        
+        // every track takes the project's grid size before its steps are copied
+        setGridSize((int)header.numRows, (int)header.numSteps);
+        
+        // the project is loaded into the track being edited
+        Song& song = getSong();
+        Song::Chain chain;
+        for(uint32 i = 0; i < header.chainLength; ++i)
+            chain.add(project.getChain()[i]);
+        if(chain.isEmpty())
+            chain.add({ 0, 1 });
+        
+        // grow before the chain refers to new patterns, shrink once it no longer refers to old ones
+        song.setNumPatterns(jmax(song.getNumPatterns(), (int)header.numPatterns));
+        song.setChain(chain);
+        song.setNumPatterns((int)header.numPatterns);
+        
+        // steps are copied as they are in the file, no parsing
+        for(int i = 0; i < (int)header.numPatterns; ++i)
+            song.setPatternSteps(i, project.getPatternSteps(i), (int)header.numSteps);
+        
+        history.reset(song.getPattern(editPattern));
+        
+        if(listener != nullptr)
+            listener->patternChanged();
+    }
+    
+    bool MidiOut::exportMidiFile(const File& file)
+    {
+        Song& song = getSong();
+        song.compilePattern(editPattern);
+        
+        Song::SchedulePublisher::ScopedRead schedule (song.getSchedule(editPattern), Song::MESSAGE_READER);
+        if(schedule.get() == nullptr)
+            return false;
+        
+        return StandardMidiFile::write(file,
+                                       *schedule.get(),
+                                       roundToInt(sequencer.getMusicalClock().getMicrosecondsPerBeat()),
+                                       sequencer.getTrack(editTrack).getVelocity());
     }
-
-    //==========================================================================
     
-    void MidiOut::timerCallback()
+    Array<TickSkew> MidiOut::simulateDinLink(const bool compact)
     {
-        // figure out how much time has elapsed
-        double elapsedTime = Time::getMillisecondCounterHiRes() - timeStart.get();
+        Song& song = getSong();
+        song.compilePattern(editPattern);
         
-        // if it is the appropriate amount of time...
-        if(elapsedTime >= (eventList.getMidiEvent(playPosition.get()).getTimeStamp() * increment))
+        Song::SchedulePublisher::ScopedRead schedule (song.getSchedule(editPattern), Song::MESSAGE_READER);
+        if(schedule.get() == nullptr)
+            return {};
+        
+        return MidiByteBudget::simulate(*schedule.get(),
+                                        sequencer.getMusicalClock(),
+                                        sequencer.getTrack(editTrack).getChannel(),
+                                        compact);
+    }
+    
+    int MidiOut::getRowForNote(const int channel, const int note) const
+    {
+        for(int i = 0; i < sequencer.getNumTracks(); ++i)
         {
-            // output the message
-            midiOutput->sendMessageNow(eventList.getMidiEvent(playPosition.get()));
-            
-            // increment to the next play position
-            playPosition.set(playPosition.get() + 1);
+            const int row = sequencer.getTrack(i).getRowForNote(channel, note);
+            if(row >= 0)
+                return row;
         }
         
-        // wrap around the play position
-        if(playPosition.get() == eventList.getSize())
+        return -1;
+    }
+    
+    bool MidiOut::importMidiFile(const File& file)
+    {
+        const Pattern current = getSong().getPattern(editPattern);
+        Pattern imported (current.getNumRows(), current.getNumSteps());
+        
+        if(StandardMidiFile::read(file, imported, (int)getSetting(PlaybackSettings::startNote)) == false)
+            return false;
+        
+        getSong().setPatternSteps(editPattern, imported.getData(), imported.getNumSteps());
+        history.recordPattern(imported);
+        
+        if(listener != nullptr)
+            listener->patternChanged();
+        
+        return true;
+    }
+    
+    void MidiOut::clearPattern()
+    {
+        editWholePattern([] (Pattern& pattern) { pattern.clear(); });
+    }
+    
+    void MidiOut::rotatePattern(const int steps)
+    {
+        editWholePattern([steps] (Pattern& pattern) { pattern.rotate(steps); });
+    }
+    
+    void MidiOut::shiftPatternRows(const int rows)
+    {
+        editWholePattern([rows] (Pattern& pattern) { pattern.shiftRows(rows); });
+    }
+    
+    void MidiOut::invertPattern()
+    {
+        editWholePattern([] (Pattern& pattern) { pattern.invert(); });
+    }
+    
+    void MidiOut::fillPatternEvery(const int interval, const int offset, const int row)
+    {
+        editWholePattern([interval, offset, row] (Pattern& pattern)
         {
-            playPosition.set(0);
-            timeStart.set(Time::getMillisecondCounterHiRes());
-        }
+            pattern.fillEvery(row < 0 ? pattern.getRowMask() : Pattern::getSingleRowMask(row), interval, offset);
+        });
+    }
+    
+    bool MidiOut::undo()
+    {
+        if(history.undo() == false)
+            return false;
+        
+        restoreFromHistory();
+        return true;
+    }
+    
+    bool MidiOut::redo()
+    {
+        if(history.redo() == false)
+            return false;
+        
+        restoreFromHistory();
+        return true;
+    }
+    
+    //==========================================================================
+    
+    void MidiOut::cartesianToggleChanged(const bool state,
+                                         const int x,
+                                         const int y)
+    {
+        const int& row = y;
+        const int& column = x;
+        
+        // patched straight into the playing schedule, or recompiled in the background
+        getSong().setStep(editPattern, row, column, state);
+        history.recordStep(row, column, state);
     }
     
     //==========================================================================
@@ -122,55 +290,102 @@ namespace audio
     {
         if(button->getComponentID() == "stop") // to be played
         {
-            // add an ending message for the length of the sequence
-            dummyMessage = MidiMessage::noteOn(1, 60, (uint8)0);
-            dummyMessage.setTimeStamp(playbackSettings["colcount"]);
-            eventList.addMidiEvent(dummyMessage);
-            
-            // ensure that settings have been updated before playback
-            preparePlayback();
-            
-            // trigger settings for starting playback
-            playPosition = 0;
-            isPlaying.set(true);
+            // every track is played by the one clock
+            sequencer.start();
             if(listener != nullptr)
                 listener->playbackStateChanged(true);
-            timeStart.set(Time::getMillisecondCounterHiRes());
-            startTimer(1);
         }
         
         if(button->getComponentID() == "play") // to be stopped
         {
             // stop playback
-            isPlaying.set(false);
+            sequencer.stop();
             if(listener != nullptr)
                 listener->playbackStateChanged(false);
-            stopTimer();
         }
     }
     
+    void MidiOut::playbackStopped()
+    {
+        triggerAsyncUpdate();
+    }
+    
+    void MidiOut::handleAsyncUpdate()
+    {
+        // playback may have been started again before this was delivered
+        if(sequencer.isRunning())
+            return;
+        
+        sequencer.stop();
+        if(listener != nullptr)
+            listener->playbackStateChanged(false);
+    }
+    
     //==========================================================================
     
-    void MidiOut::preparePlayback()
+    void MidiOut::restoreFromHistory()
+    {
+        Song& song = getSong();
+        Pattern pattern = song.getPattern(editPattern);
+        history.copyCurrentTo(pattern);
+        song.setPatternSteps(editPattern, pattern.getData(), pattern.getNumSteps());
+        
+        if(listener != nullptr)
+            listener->patternChanged();
+    }
+    
+    template <typename Edit>
+    void MidiOut::editWholePattern(Edit&& edit)
     {
-        // calculate increment length for each step
-        increment = (330.0 - playbackSettings["tempo"])
-                        / 60.0f /* secPerMin */
-                        / playbackSettings["colcount"]  /* beatsInABar */
-                        * 1000 /* for milliseconds*/;
+        Song& song = getSong();
+        Pattern pattern = song.getPattern(editPattern);
+        edit(pattern);
         
-        // check message velocities within list
-        for(int i = 0; i < eventList.getSize(); i++)
+        // one recompile & one repaint, rather than one per step changed
+        song.setPatternSteps(editPattern, pattern.getData(), pattern.getNumSteps());
+        history.recordPattern(pattern);
+        
+        if(listener != nullptr)
+            listener->patternChanged();
+    }
+    
+    void MidiOut::playbackSettingChanged(const PlaybackSettings::Setting setting, const float value)
+    {
+        if(setting == PlaybackSettings::tempo)
+        {
+            // the tempo slider is in quarter notes per minute
+            sequencer.setTempo(value);
+        }
+        else if(setting == PlaybackSettings::noteMode)
+        {
+            // every pattern recompiles with its steps merged or split
+            for(int i = 0; i < sequencer.getNumTracks(); ++i)
+                sequencer.getTrack(i).getSong().setNoteMode(getNoteMode());
+        }
+        else if(setting == PlaybackSettings::swing)
+        {
+            // resolved onto the tick time line as each pattern recompiles
+            for(int i = 0; i < sequencer.getNumTracks(); ++i)
+                sequencer.getTrack(i).getSong().setSwing(value);
+        }
+        else if(setting == PlaybackSettings::compactOutput)
+        {
+            // every port switches encoding from its next message
+            for(int i = 0; i < sequencer.getNumPorts(); ++i)
+                sequencer.getPort(i).setCompact(value >= 0.5f);
+        }
+        else if(setting == PlaybackSettings::velocity)
+        {
+            // applied as each note is sent, nothing is recompiled
+            for(int i = 0; i < sequencer.getNumTracks(); ++i)
+                sequencer.getTrack(i).setVelocity(jlimit(1, 127, (int)value));
+        }
+        else
         {
-            if(eventList.getMidiEvent(i).isNoteOn())
-            {
-                if(eventList.getMidiEvent(i).getVelocity() != (uint8)playbackSettings["velocity"])
-                {
-                    auto newEvent = eventList.getMidiEvent(i);
-                    newEvent.setVelocity(playbackSettings["velocity"] / 127.0f);
-                    eventList.setMidiEvent(i, newEvent);
-                }
-            }
+            // update the notes built for each step of every track
+            for(int i = 0; i < sequencer.getNumTracks(); ++i)
+                sequencer.getTrack(i).getSong().setStepNotes((int)playbackSettings.get(PlaybackSettings::startNote),
+                                                             (uint8)playbackSettings.get(PlaybackSettings::velocity));
         }
     }
     
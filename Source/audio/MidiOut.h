@@ -12,7 +12,12 @@
 
 #pragma once
 
-#include "MidiEventList.h"
+#include "Sequencer.h"
+#include "PlaybackSettings.h"
+#include "ProjectFile.h"
+#include "StandardMidiFile.h"
+#include "MidiWire.h"
+#include "PatternHistory.h"
 #include "../gui/widgets/CartesianToggleButton.h"
 #include "../JuceLibraryCode/JuceHeader.h"
 
@@ -21,14 +26,16 @@
 namespace audio
 {
     /**
-     *  MidiOut singleton for scheduling and playback of midi messages.
+     *  MidiOut singleton, the interface's front end to the sequencer. The
+     *  grid edits one track at a time while the @see Sequencer plays them all.
      */
     class MidiOut : public gui::CartesianToggleButton::Listener,
-                    public Timer,
-                    public Button::Listener
+                    public Button::Listener,
+                    private PlaybackSettings::Listener,
+                    private Sequencer::Listener,
+                    private AsyncUpdater
     {
     public:
-        
         /**
          *  The accessor for the only instance of this class
          *  @return A reference to the static class instance.
@@ -46,23 +53,46 @@ namespace audio
                                     const int y) override;
         
         /**
-         *  Returns the paired float value for the input string.
-         *  @param  the label for a synthesiser setting param.
+         *  Returns the value of a playback setting, a single atomic load.
+         *  @param  the playback setting.
          *  @return the value for the input setting.
          */
-        float getSetting(String setting) const;
+        float getSetting(const PlaybackSettings::Setting setting) const { return playbackSettings.get(setting); }
         
         /**
          * Wrapper for setting parameters for each playback setting.
-         * @param  setting is the label for a syntheisiser param.
+         * @param  setting is the playback setting.
          * @param  value is the value for the passed parameter.
          */
-        void setPlayback (String setting, float value);
+        void setPlayback (const PlaybackSettings::Setting setting, const float value);
+        
+        /**
+         *  Accessor for the playback settings, for subscribing to changes.
+         *  @return the playback settings.
+         */
+        PlaybackSettings& getPlaybackSettings() { return playbackSettings; }
         
         /**
-         *  Timer outputting midi messages from the event list based on timecode.
+         *  Getter for how steps are turned into notes, from the note mode
+         *  setting.
+         *  @return legato if runs of steps are merged into single notes.
          */
-        void timerCallback() override;
+        MidiEventList::NoteMode getNoteMode() const;
+        
+        /**
+         * Sizes the step grid of the event list, clearing all steps.
+         * @param  rowCount is the number of rows (notes) in the sequencer.
+         * @param  columnCount is the number of steps in each row.
+         */
+        void setGridSize (const int rowCount, const int columnCount);
+        
+        /**
+         * Returns the state of a step in the pattern being edited.
+         * @param  row is the row index of the step.
+         * @param  column is the column index of the step.
+         * @return true if the step is active.
+         */
+        bool getStep (const int row, const int column) const;
         
         /**
          *  Callback for button clicks.
@@ -86,6 +116,11 @@ namespace audio
              *  @param  if the sequencer is currently playing.
              */
             virtual void playbackStateChanged(bool isPlaying) = 0;
+            
+            /**
+             *  Alerts when the steps have been replaced, e.g. by loading.
+             */
+            virtual void patternChanged() = 0;
         };
         
         /**
@@ -94,9 +129,152 @@ namespace audio
          */
         void addListener(Listener* listenerParam) { listener = listenerParam; }
         
+        /**
+         *  Sets how far ahead the clock renders events for the output to send.
+         *  A longer window rides out scheduling hiccups but delays live edits.
+         *  @param the lookahead in milliseconds.
+         */
+        void setLookahead(const int milliseconds);
+        
+        /** Getter for the lookahead in milliseconds. */
+        int getLookahead() const { return sequencer.getLookahead(); }
+        
+        /**
+         *  Sets the resolution of the playback clock, only while stopped.
+         *  @param the ticks in each quarter note, a multiple of four.
+         */
+        void setPpq (const int ticksPerQuarterNote);
+        
+        /** Getter for the ticks in each quarter note. */
+        int getPpq() const { return sequencer.getMusicalClock().getPpq(); }
+        
         /** Getter for retreiving playstate of midi output. */
-        bool getPlaying() const { return isPlaying.get(); }
+        bool getPlaying() const { return sequencer.isRunning(); }
         
+        /**
+         *  Accessor for the scheduler playing every track.
+         *  @return the sequencer.
+         */
+        Sequencer& getSequencer() { return sequencer; }
+        
+        /**
+         *  Opens a hardware midi output as another port of the sequencer.
+         *  @param the identifier of the device, @see MidiOutput::getAvailableDevices.
+         *  @return the index of the port, or -1 if the device could not be opened.
+         */
+        int openOutputDevice(const String& deviceIdentifier);
+        
+        /**
+         *  Adds a track sized to the grid, using the current step notes.
+         *  @return the index of the new track.
+         */
+        int addTrack();
+        
+        /**
+         *  Chooses the track the grid edits, then tells the listener the
+         *  pattern has changed. The undo history starts again.
+         *  @param the index of the track.
+         */
+        void setEditTrack(const int index);
+        
+        /** Getter for the index of the track being edited. */
+        int getEditTrack() const { return editTrack; }
+        
+        /**
+         *  Accessor for the song arrangement of the track being edited, for
+         *  adding patterns & chaining.
+         *  @return the song of the track being edited.
+         */
+        Song& getSong() { return sequencer.getTrack(editTrack).getSong(); }
+        
+        /** Accessor for the song of the track being edited. */
+        const Song& getSong() const { return sequencer.getTrack(editTrack).getSong(); }
+        
+        /**
+         *  Fills in the playback fields of a project's settings.
+         *  @param the settings to be saved.
+         */
+        void getSettings(ProjectSettings& settings) const;
+        
+        /**
+         *  Loads the grid size, note mode, patterns, chain & playback settings
+         *  of a project, then tells the listener the pattern has changed.
+         *  @param a valid, mapped project file.
+         */
+        void loadProject(const ProjectFile& project);
+        
+        /**
+         *  Streams the pattern being edited to a standard midi file.
+         *  @param the midi file to be written.
+         *  @return true if the file was written.
+         */
+        bool exportMidiFile(const File& file);
+        
+        /**
+         *  Replaces the pattern being edited with the notes of a standard midi
+         *  file, each note number from startnote upwards is a row.
+         *  @param the midi file to be read.
+         *  @return true if the whole file was read.
+         */
+        bool importMidiFile(const File& file);
+        
+        /**
+         *  Simulates sending the pattern being edited down a DIN midi link
+         *  at the current tempo.
+         *  @param true to simulate running status & velocity 0 note offs.
+         *  @return how late each tick with notes on it lands.
+         */
+        Array<TickSkew> simulateDinLink(const bool compact);
+        
+        /**
+         *  Finds the row a note sent by the sequencer was played by, the
+         *  first track with a row sending it wins. Lock free, so safe to
+         *  call as each note on arrives at the synth.
+         *  @param channel is the midi channel the note was sent on.
+         *  @param note is the note number.
+         *  @return the row, or -1 if no track sends the note.
+         */
+        int getRowForNote(const int channel, const int note) const;
+        
+        /** Turns every step of the pattern being edited off. */
+        void clearPattern();
+        
+        /**
+         *  Rotates the pattern being edited in time, steps wrap around.
+         *  @param the number of steps later, or earlier if negative.
+         */
+        void rotatePattern(const int steps);
+        
+        /**
+         *  Moves the steps of the pattern being edited up or down rows,
+         *  steps pushed off the grid are dropped.
+         *  @param the number of rows up, or down if negative.
+         */
+        void shiftPatternRows(const int rows);
+        
+        /** Turns every step of the pattern being edited that is off on, and on off. */
+        void invertPattern();
+        
+        /**
+         *  Turns on every nth step of the pattern being edited.
+         *  @param interval is the number of steps between each one turned on.
+         *  @param offset is the first step turned on.
+         *  @param row is the row to be filled, or -1 for every row.
+         */
+        void fillPatternEvery(const int interval, const int offset = 0, const int row = -1);
+        
+        /**
+         *  Undoes the last edit to the pattern being edited.
+         *  @return true if there was an edit to undo.
+         */
+        bool undo();
+        
+        /**
+         *  Redoes the last undone edit to the pattern being edited.
+         *  @return true if there was an edit to redo.
+         */
+        bool redo();
+    
     private:
         /** Pointer to the playback state listener. */
         Listener* listener;
@@ -125,30 +303,51 @@ namespace audio
          */
         void operator= (const MidiOut&);
         
-        /** 
-         *  Calculates the increment required for tempo & velocity.
+        /**
+         *  Updates the time base or the step notes when a setting they are
+         *  built from changes.
+         *  @param setting is the setting that changed.
+         *  @param value is its new value.
          */
-        void preparePlayback();
+        void playbackSettingChanged(const PlaybackSettings::Setting setting, const float value) override;
         
-        /** Hash map for each playback setting parameters.*/
-        HashMap<String, float> playbackSettings;
-        /** Pointer for the sequencers virtual midi output device. */
-        std::unique_ptr<MidiOutput> midiOutput;
+        /**
+         *  Passes the clock stopping itself over to the message thread.
+         *  Called on the clock thread.
+         */
+        void playbackStopped() override;
+        
+        /**
+         *  Finishes stopping once the clock has stopped itself, releasing
+         *  held notes, then tells the listener playback has stopped.
+         */
+        void handleAsyncUpdate() override;
         
-        /** The list of events ready for playback. */
-        MidiEventList eventList;
-        /** The current play position within the event list.*/
-        Atomic<int> playPosition;
-        /** The time playback started. */
-        Atomic<double> timeStart;
-        /** The current state of playback. */
-        Atomic<bool> isPlaying;
+        /**
+         *  Copies the current version in the history into the pattern being
+         *  edited, then tells the listener the pattern has changed.
+         */
+        void restoreFromHistory();
         
-        /** Increment amount for the change in tempo. */
-        float increment;
+        /**
+         *  Edits the whole pattern being edited as one undoable step. The song
+         *  is recompiled once and the listener told once, however many steps
+         *  the edit changes.
+         *  @param called with a copy of the pattern to be edited.
+         */
+        template <typename Edit>
+        void editWholePattern(Edit&& edit);
         
-        /** A sys ex message for blank output steps in the sequencer. */
-        MidiMessage dummyMessage;
+        /** Each playback setting, readable from any thread. */
+        PlaybackSettings playbackSettings;
+        /** Plays every track, port 0 is the virtual output device. */
+        Sequencer sequencer;
+        /** The track the sequencer grid edits. */
+        int editTrack;
+        /** The pattern the sequencer grid edits. */
+        int editPattern;
+        /** Every version of the pattern being edited, for undo & redo. */
+        PatternHistory history;
     };
     
 } //namespace audio
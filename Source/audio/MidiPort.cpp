@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+    MidiPort.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "MidiPort.h"
+
+namespace audio
+{
+    MidiPort::MidiPort(std::unique_ptr<MidiOutput> device) : Thread("midi port"),
+                                                             output(std::move(device)),
+                                                             fifo(QUEUE_SIZE)
+    {
+        // a port needs a device to send to!!!
+        jassert(output != nullptr);
+        
+        queue.malloc((size_t)QUEUE_SIZE);
+        numPushed.set(0);
+        numPopped = 0;
+        dropBefore.set(0);
+        compact.set(0);
+        woken = false;
+        
+        startThread(Thread::realtimeAudioPriority);
+    }
+    
+    MidiPort::~MidiPort()
+    {
+        signalThreadShouldExit();
+        send();
+        stopThread(1000);
+    }
+    
+    //==========================================================================
+    
+    bool MidiPort::push(const std::chrono::steady_clock::time_point time, const uint32 message)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        
+        if(size1 == 0)
+            return false; // full, the device has fallen behind
+        
+        queue[start1] = { time, message };
+        fifo.finishedWrite(1);
+        ++numPushed;
+        return true;
+    }
+    
+    void MidiPort::send()
+    {
+        {
+            const std::lock_guard<std::mutex> wakeLock (wakeMutex);
+            woken = true;
+        }
+        wakeCondition.notify_one();
+    }
+    
+    void MidiPort::clear()
+    {
+        dropBefore.set(numPushed.get());
+        send();
+    }
+    
+    //==========================================================================
+    
+    void MidiPort::run()
+    {
+        typedef std::chrono::steady_clock Clock;
+        
+        while(threadShouldExit() == false)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(1, start1, size1, start2, size2);
+            
+            if(size1 == 0)
+            {
+                // nothing queued, sleep until something is pushed
+                waitUntil(Clock::now() + std::chrono::seconds(1));
+                continue;
+            }
+            
+            const QueuedEvent& event = queue[start1];
+            
+            if(numPopped < dropBefore.get())
+            {
+                // cleared before it was sent
+                fifo.finishedRead(1);
+                ++numPopped;
+                continue;
+            }
+            
+            if(event.time > Clock::now())
+            {
+                // events are queued in time order, so nothing else is due either
+                waitUntil(event.time);
+                continue;
+            }
+            
+            const uint32 message = compact.get() != 0 ? MidiWireEncoder::toNoteOnOff(event.message) : event.message;
+            
+            // only this thread ever waits on the device
+            output->sendMessageNow(ScheduledEvent { 0, message }.toMidiMessage());
+            fifo.finishedRead(1);
+            ++numPopped;
+        }
+    }
+    
+    void MidiPort::waitUntil(const std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> wakeLock (wakeMutex);
+        wakeCondition.wait_until(wakeLock, deadline, [this] { return woken || threadShouldExit(); });
+        woken = false;
+    }
+    
+} //namespace audio
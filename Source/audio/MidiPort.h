@@ -0,0 +1,128 @@
+/**
+ *  @file    MidiPort.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  A midi output device with its own send thread, fed by a lock free queue.
+ *
+ */
+
+#pragma once
+
+#include "PlaybackSchedule.h"
+#include "MidiWire.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  A midi output device with its own send thread. The clock pushes time
+     *  stamped events into a lock free queue & the thread sends each one when
+     *  it is due, so a slow or blocked device only ever delays itself.
+     *
+     *  There must be a single thread pushing at a time, the clock while
+     *  playing and the message thread while stopped.
+     */
+    class MidiPort : private Thread
+    {
+    public:
+        /** The most events that can be queued at once. */
+        static const int QUEUE_SIZE = 4096;
+        
+        /**
+         *  Constructor. Starts the send thread.
+         *  @param the device to send to, this takes ownership.
+         */
+        MidiPort(std::unique_ptr<MidiOutput> device);
+        
+        /** Destructor. Stops the send thread, anything still queued is dropped. */
+        ~MidiPort();
+        
+        /** Getter for the name of the device. */
+        String getName() const { return output->getName(); }
+        
+        /**
+         *  Queues an event. Lock free, call send once a block is pushed.
+         *  @param time is when the event is due.
+         *  @param message is the packed midi message.
+         *  @return false if the queue is full & the event was dropped.
+         */
+        bool push(const std::chrono::steady_clock::time_point time, const uint32 message);
+        
+        /** Wakes the send thread to look at what has been pushed. */
+        void send();
+        
+        /**
+         *  Drops everything queued so far, anything pushed afterwards is still
+         *  sent. Lock free.
+         */
+        void clear();
+        
+        /**
+         *  Sets whether note offs are sent as note ons of velocity 0, so a
+         *  hardware interface using running status sends a burst of notes
+         *  behind a single status byte. Lock free.
+         *  @param true for the compact encoding.
+         */
+        void setCompact(const bool shouldBeCompact) { compact.set(shouldBeCompact ? 1 : 0); }
+        
+        /** Getter for whether note offs are sent as note ons of velocity 0. */
+        bool getCompact() const { return compact.get() != 0; }
+    
+    private:
+        /** An event waiting in the queue. */
+        struct QueuedEvent
+        {
+            /** When the event is due. */
+            std::chrono::steady_clock::time_point time;
+            /** The packed midi message. */
+            uint32 message;
+        };
+        
+        /** Private constructor. Must provide a device! */
+        MidiPort();
+        
+        /** Sends each queued event as it becomes due. */
+        void run() override;
+        
+        /**
+         *  Sleeps the send thread until a deadline, or until it is woken.
+         *  @param the absolute time to wake at.
+         */
+        void waitUntil(const std::chrono::steady_clock::time_point deadline);
+        
+        /** The device. */
+        std::unique_ptr<MidiOutput> output;
+        
+        /** Single producer, single consumer indices into the queue. */
+        AbstractFifo fifo;
+        /** The queued events. */
+        HeapBlock<QueuedEvent> queue;
+        /** The number of events ever pushed. */
+        Atomic<int64> numPushed;
+        /** The number of events ever taken off the queue. */
+        int64 numPopped;
+        /** Events before this count are dropped rather than sent. */
+        Atomic<int64> dropBefore;
+        /** Non zero while note offs are sent as note ons of velocity 0. */
+        Atomic<int> compact;
+        
+        /** Guards the wake flag. */
+        std::mutex wakeMutex;
+        /** Signalled when events have been pushed. */
+        std::condition_variable wakeCondition;
+        /** Set when the send thread has been woken. */
+        bool woken;
+        
+        JUCE_DECLARE_NON_COPYABLE (MidiPort)
+    };
+    
+} //namespace audio
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    MidiWire.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "MidiWire.h"
+
+namespace audio
+{
+    MidiWireEncoder::MidiWireEncoder(const bool noteOffAsNoteOnParam)
+    {
+        runningStatus = 0;
+        noteOffAsNoteOn = noteOffAsNoteOnParam;
+    }
+    
+    MidiWireEncoder::~MidiWireEncoder(){}
+    
+    //==========================================================================
+    
+    int MidiWireEncoder::encode(const uint32 message, uint8* bytes)
+    {
+        const ScheduledEvent event { 0, noteOffAsNoteOn ? toNoteOnOff(message) : message };
+        const uint8 status = event.getStatus();
+        const int size = jlimit(1, 3, MidiMessage::getMessageLengthFromFirstByte(status));
+        
+        // system messages can't run, and real time ones don't change the running status
+        const bool running = status < 0xf0 && status == runningStatus;
+        if(status < 0xf0)
+            runningStatus = status;
+        else if(status < 0xf8)
+            runningStatus = 0;
+        
+        // while the receiver still has the status, only the data is sent
+        int count = 0;
+        if(running == false)
+            bytes[count++] = status;
+        
+        if(size > 1)
+            bytes[count++] = event.getData1();
+        if(size > 2)
+            bytes[count++] = event.getData2();
+        
+        return count;
+    }
+    
+    uint32 MidiWireEncoder::toNoteOnOff(const uint32 message)
+    {
+        if((message & 0xf0) != 0x80)
+            return message;
+        
+        // same channel & note, velocity 0
+        return (message & 0xff0f) | 0x90;
+    }
+    
+    int MidiWireEncoder::getPriority(const uint32 message)
+    {
+        const ScheduledEvent event { 0, message };
+        const uint8 type = event.getStatus() & 0xf0;
+        
+        if(type == 0x80 || (type == 0x90 && event.getData2() == 0))
+            return 0;
+        
+        return type == 0x90 ? 1 : 2;
+    }
+    
+    //==========================================================================
+    
+    Array<TickSkew> MidiByteBudget::simulate(const PlaybackSchedule& schedule,
+                                             const MusicalClock& clock,
+                                             const int channel,
+                                             const bool compact)
+    {
+        const double microsecondsPerByte = 1000000.0 / DIN_BYTES_PER_SECOND;
+        const double microsecondsPerTick = clock.ticksToNanoseconds(1) / 1000.0;
+        
+        MidiWireEncoder encoder (compact);
+        Array<TickSkew> ticks;
+        double lineFreeAt = 0.0;
+        uint8 bytes[3];
+        
+        for(int i = 0; i < schedule.getNumEvents();)
+        {
+            TickSkew skew { schedule.getEvent(i).tick, 0, 0, 0.0 };
+            
+            // the link is either idle when the tick is due, or still busy with earlier ticks
+            const double due = skew.tick * microsecondsPerTick;
+            double sentAt = jmax(due, lineFreeAt);
+            
+            for(; i < schedule.getNumEvents() && schedule.getEvent(i).tick == skew.tick; ++i)
+            {
+                // as the sequencer sends it, on the track's channel
+                const ScheduledEvent& event = schedule.getEvent(i);
+                const uint32 message = (channel > 0 && event.getStatus() < 0xf0) ? ((event.message & ~(uint32)0x0f) | (uint32)((channel - 1) & 0x0f))
+                                                                                 : event.message;
+                const int size = compact ? encoder.encode(message, bytes)
+                                         : jlimit(1, 3, MidiMessage::getMessageLengthFromFirstByte((uint8)(message & 0xff)));
+                
+                sentAt += size * microsecondsPerByte;
+                ++skew.numMessages;
+                skew.numBytes += size;
+            }
+            
+            lineFreeAt = sentAt;
+            skew.skewMicroseconds = sentAt - due;
+            ticks.add(skew);
+        }
+        
+        return ticks;
+    }
+    
+    double MidiByteBudget::getWorstSkew(const Array<TickSkew>& ticks)
+    {
+        double worst = 0.0;
+        for(auto& tick : ticks)
+            worst = jmax(worst, tick.skewMicroseconds);
+        
+        return worst;
+    }
+    
+} //namespace audio
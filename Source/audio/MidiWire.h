@@ -0,0 +1,129 @@
+/**
+ *  @file    MidiWire.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Byte level encoding of midi for slow serial links, and a simulator of
+ *  how late each tick of a pattern lands on one.
+ *
+ */
+
+#pragma once
+
+#include "PlaybackSchedule.h"
+#include "MusicalClock.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  Encodes packed messages into the bytes sent down a serial link. A
+     *  status byte is only sent when it differs from the last one (running
+     *  status), and note offs can be sent as note ons of velocity 0 so a
+     *  burst of notes shares a single status byte.
+     */
+    class MidiWireEncoder
+    {
+    public:
+        /**
+         *  Constructor. Starts with no running status.
+         *  @param whether note offs are sent as note ons of velocity 0.
+         */
+        MidiWireEncoder(const bool noteOffAsNoteOn = true);
+        
+        /** Destructor. */
+        ~MidiWireEncoder();
+        
+        /**
+         *  Encodes the next message.
+         *  @param message is the packed midi message.
+         *  @param bytes receives up to 3 bytes.
+         *  @return the number of bytes written.
+         */
+        int encode(const uint32 message, uint8* bytes);
+        
+        /** Forgets the running status, e.g. once a receiver may have lost it. */
+        void reset() { runningStatus = 0; }
+        
+        /**
+         *  Turns a note off into a note on of velocity 0, anything else is
+         *  left as it is.
+         *  @param the packed midi message.
+         *  @return the packed message to send.
+         */
+        static uint32 toNoteOnOff(const uint32 message);
+        
+        /**
+         *  The order messages due at the same time are sent in, lowest first.
+         *  Note offs free voices before the notes that need them.
+         *  @param the packed midi message.
+         *  @return 0 for a note off, 1 for a note on, 2 for anything else.
+         */
+        static int getPriority(const uint32 message);
+    
+    private:
+        /** The last status byte sent, or 0 if none. */
+        uint8 runningStatus;
+        /** Whether note offs are sent as note ons of velocity 0. */
+        bool noteOffAsNoteOn;
+    };
+    
+    //==========================================================================
+    
+    /**
+     *  How late a tick of a pattern lands on a serial link.
+     */
+    struct TickSkew
+    {
+        /** The tick in the schedule. */
+        uint32 tick;
+        /** The number of messages due on it. */
+        int numMessages;
+        /** The number of bytes sent for them. */
+        int numBytes;
+        /** How long after the tick the last byte of its last message is sent. */
+        double skewMicroseconds;
+    };
+    
+    /**
+     *  Simulates sending a schedule down a 31.25 kbaud DIN link, where each
+     *  byte takes 320 microseconds, to find how late each tick lands.
+     */
+    class MidiByteBudget
+    {
+    public:
+        /** Bytes per second of a DIN link, 31250 baud at 10 bits a byte. */
+        static const int DIN_BYTES_PER_SECOND = 3125;
+        
+        /**
+         *  Sends one loop of a schedule down a simulated link. Bytes still
+         *  being sent when a tick is due push that tick later.
+         *  @param schedule is the compiled pattern.
+         *  @param clock is the tempo the pattern is played at.
+         *  @param channel is the track's channel messages are moved onto, or 0 for the rows' own.
+         *  @param compact is true to use running status & velocity 0 note offs.
+         *  @return every tick with messages on it, in time order.
+         */
+        static Array<TickSkew> simulate(const PlaybackSchedule& schedule,
+                                        const MusicalClock& clock,
+                                        const int channel,
+                                        const bool compact);
+        
+        /**
+         *  Finds the worst skew of a simulation.
+         *  @param the ticks of a simulation.
+         *  @return the latest any tick lands, in microseconds.
+         */
+        static double getWorstSkew(const Array<TickSkew>& ticks);
+    
+    private:
+        /** Private constructor. Static functions only! */
+        MidiByteBudget();
+    };
+    
+} //namespace audio
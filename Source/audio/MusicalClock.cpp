@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    MusicalClock.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "MusicalClock.h"
+
+namespace audio
+{
+    MusicalClock::MusicalClock()
+    {
+        tempo = 120.0;
+        ppq = DEFAULT_PPQ;
+        update();
+    }
+    
+    MusicalClock::~MusicalClock(){}
+    
+    //==========================================================================
+    
+    void MusicalClock::setTempo(const double beatsPerMinute)
+    {
+        // the tempo must be positive!!!
+        jassert(beatsPerMinute > 0.0);
+        
+        tempo = jmax(1.0, beatsPerMinute);
+        update();
+    }
+    
+    void MusicalClock::setPpq(const int ticksPerQuarterNote)
+    {
+        // each step must be a whole number of ticks!!!
+        jassert(ticksPerQuarterNote >= STEPS_PER_BEAT && ticksPerQuarterNote % STEPS_PER_BEAT == 0);
+        
+        ppq = jmax(STEPS_PER_BEAT, ticksPerQuarterNote - ticksPerQuarterNote % STEPS_PER_BEAT);
+        update();
+    }
+    
+    void MusicalClock::update()
+    {
+        nanosecondsPerTick = 60.0e9 / (tempo * ppq);
+        tickLength = (uint64)(nanosecondsPerTick * 4294967296.0 + 0.5);
+    }
+    
+} //namespace audio
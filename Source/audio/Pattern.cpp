@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+
+    Pattern.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "Pattern.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define PATTERN_USE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define PATTERN_USE_NEON 1
+#endif
+
+namespace audio
+{
+    Pattern::Pattern(const int rows, const int stepCount)
+    {
+        numRows = 0;
+        numSteps = 0;
+        setSize(rows, stepCount);
+    }
+    
+    Pattern::~Pattern(){}
+    
+    void Pattern::setSize(const int rows, const int stepCount)
+    {
+        // a step mask only holds 128 rows!!!
+        jassert(rows >= 0 && rows <= MAX_ROWS);
+        // nor can a pattern be longer than MAX_STEPS!!!
+        jassert(stepCount >= 0 && stepCount <= MAX_STEPS);
+        
+        // release builds clamp too, the row masks have no room for more
+        numRows = jlimit(0, MAX_ROWS, rows);
+        numSteps = jlimit(0, MAX_STEPS, stepCount);
+        
+        StepMask empty = {{ 0, 0 }};
+        steps.clearQuick();
+        steps.insertMultiple(0, empty, numSteps);
+    }
+    
+    //==========================================================================
+    
+    void Pattern::setStep(const int row, const int step, const bool state)
+    {
+        // the step you are setting is outside the pattern!!!
+        jassert(row >= 0 && row < numRows && step >= 0 && step < numSteps);
+        
+        uint64& word = steps.getReference(step).bits[row >> 6];
+        const uint64 bit = (uint64)1 << (row & 63);
+        
+        if(state)
+            word |= bit;
+        else
+            word &= ~bit;
+    }
+    
+    bool Pattern::getStep(const int row, const int step) const
+    {
+        // the step you are getting is outside the pattern!!!
+        jassert(row >= 0 && row < numRows && step >= 0 && step < numSteps);
+        
+        return (steps.getReference(step).bits[row >> 6] >> (row & 63)) & 1;
+    }
+    
+    const StepMask& Pattern::getStepMask(const int step) const
+    {
+        // the step you are getting is outside the pattern!!!
+        jassert(step >= 0 && step < numSteps);
+        
+        return steps.getReference(step);
+    }
+    
+    void Pattern::copyFrom(const StepMask* source, const int stepCount)
+    {
+        const int count = jlimit(0, numSteps, stepCount);
+        StepMask* masks = steps.getRawDataPointer();
+        
+        memcpy(masks, source, sizeof(StepMask) * (size_t)count);
+        zeromem(masks + count, sizeof(StepMask) * (size_t)(numSteps - count));
+        
+        // drop any rows this pattern does not have
+        const StepMask rowMask = getRowMask();
+        for(int step = 0; step < count; ++step)
+        {
+            masks[step].bits[0] &= rowMask.bits[0];
+            masks[step].bits[1] &= rowMask.bits[1];
+        }
+    }
+    
+    //==========================================================================
+    
+    void Pattern::clear()
+    {
+        zeromem(steps.getRawDataPointer(), sizeof(StepMask) * (size_t)numSteps);
+    }
+    
+    void Pattern::rotate(const int amount)
+    {
+        if(numSteps == 0)
+            return;
+        
+        // whole step masks are moved, the rows within them are untouched
+        const int shift = ((amount % numSteps) + numSteps) % numSteps;
+        StepMask* masks = steps.getRawDataPointer();
+        std::rotate(masks, masks + (numSteps - shift), masks + numSteps);
+    }
+    
+    void Pattern::shiftRows(const int amount)
+    {
+        const StepMask rowMask = getRowMask();
+        StepMask* masks = steps.getRawDataPointer();
+        
+        // a 128 bit shift of each step, carrying bits between the two words
+        for(int step = 0; step < numSteps; ++step)
+        {
+            uint64& low = masks[step].bits[0];
+            uint64& high = masks[step].bits[1];
+            
+            if(amount >= MAX_ROWS || amount <= -MAX_ROWS)
+            {
+                low = high = 0;
+            }
+            else if(amount >= 64)
+            {
+                high = low << (amount - 64);
+                low = 0;
+            }
+            else if(amount > 0)
+            {
+                high = (high << amount) | (low >> (64 - amount));
+                low <<= amount;
+            }
+            else if(amount <= -64)
+            {
+                low = high >> (-amount - 64);
+                high = 0;
+            }
+            else if(amount < 0)
+            {
+                low = (low >> -amount) | (high << (64 + amount));
+                high >>= -amount;
+            }
+            
+            low &= rowMask.bits[0];
+            high &= rowMask.bits[1];
+        }
+    }
+    
+    void Pattern::invert()
+    {
+        const StepMask rowMask = getRowMask();
+        StepMask* masks = steps.getRawDataPointer();
+        
+        for(int step = 0; step < numSteps; ++step)
+        {
+            masks[step].bits[0] ^= rowMask.bits[0];
+            masks[step].bits[1] ^= rowMask.bits[1];
+        }
+    }
+    
+    void Pattern::fillEvery(const StepMask& rows, const int interval, const int offset)
+    {
+        // a step can't repeat every 0 steps!!!
+        jassert(interval > 0);
+        
+        const StepMask rowMask = getRowMask();
+        const StepMask fill { { rows.bits[0] & rowMask.bits[0], rows.bits[1] & rowMask.bits[1] } };
+        StepMask* masks = steps.getRawDataPointer();
+        
+        for(int step = jmax(0, offset); step < numSteps; step += jmax(1, interval))
+        {
+            masks[step].bits[0] |= fill.bits[0];
+            masks[step].bits[1] |= fill.bits[1];
+        }
+    }
+    
+    StepMask Pattern::getRowMask() const
+    {
+        StepMask mask;
+        for(int word = 0; word < 2; ++word)
+        {
+            const int rowsInWord = jlimit(0, 64, numRows - word * 64);
+            mask.bits[word] = rowsInWord == 64 ? ~(uint64)0 : (((uint64)1 << rowsInWord) - 1);
+        }
+        
+        return mask;
+    }
+    
+    StepMask Pattern::getSingleRowMask(const int row)
+    {
+        // the row is outside a step mask!!!
+        jassert(row >= 0 && row < MAX_ROWS);
+        
+        StepMask mask = {{ 0, 0 }};
+        mask.bits[(row >> 6) & 1] = (uint64)1 << (row & 63);
+        return mask;
+    }
+    
+    //==========================================================================
+    
+    int Pattern::findNextActiveStep(int step) const
+    {
+        const StepMask* masks = steps.getRawDataPointer();
+       
+       #if PATTERN_USE_SSE2
+        // test four steps per compare while they are all empty
+        const __m128i zero = _mm_setzero_si128();
+        for(; step + 4 <= numSteps; step += 4)
+        {
+            const __m128i* block = reinterpret_cast<const __m128i*>(masks + step);
+            const __m128i any = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(block), _mm_loadu_si128(block + 1)),
+                                             _mm_or_si128(_mm_loadu_si128(block + 2), _mm_loadu_si128(block + 3)));
+            
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero)) != 0xffff)
+                break;
+        }
+       #elif PATTERN_USE_NEON
+        for(; step + 4 <= numSteps; step += 4)
+        {
+            const uint64* block = masks[step].bits;
+            const uint64x2_t any = vorrq_u64(vorrq_u64(vld1q_u64(block), vld1q_u64(block + 2)),
+                                             vorrq_u64(vld1q_u64(block + 4), vld1q_u64(block + 6)));
+            
+            if((vgetq_lane_u64(any, 0) | vgetq_lane_u64(any, 1)) != 0)
+                break;
+        }
+       #endif
+        
+        // finish off one step at a time
+        for(; step < numSteps; ++step)
+        {
+            if(masks[step].isEmpty() == false)
+                return step;
+        }
+        
+        return numSteps;
+    }
+    
+    int Pattern::getNumActiveSteps() const
+    {
+        int count = 0;
+        
+        for(int step = findNextActiveStep(0); step < numSteps; step = findNextActiveStep(step + 1))
+        {
+            const StepMask& mask = steps.getReference(step);
+            count += countNumberOfBits(mask.bits[0]) + countNumberOfBits(mask.bits[1]);
+        }
+        
+        return count;
+    }
+    
+} //namespace audio
@@ -0,0 +1,243 @@
+/**
+ *  @file    Pattern.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  A compact bitset of sequencer steps, one bit per (row, step).
+ *
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#if defined(_MSC_VER)
+ #include <intrin.h>
+#endif
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  The rows active on a single step, one bit per row. 16 bytes, so each
+     *  step is exactly one SIMD register.
+     */
+    struct StepMask
+    {
+        /** Rows 0 - 63, then rows 64 - 127. */
+        uint64 bits[2];
+        
+        /** Checks if any row is active on this step. */
+        bool isEmpty() const { return (bits[0] | bits[1]) == 0; }
+    };
+    
+    //==========================================================================
+    
+    /**
+     *  A compact bitset of sequencer steps, stored step by step so a pattern
+     *  is scanned in time order. 128 rows by 4096 steps takes 64kb and empty
+     *  steps are skipped several at a time with SIMD compares.
+     */
+    class Pattern
+    {
+    public:
+        /** The most rows a pattern can hold, the bits in a StepMask. */
+        static const int MAX_ROWS = 128;
+        
+        /** The most steps a pattern can hold. */
+        static const int MAX_STEPS = 64;
+        
+        /**
+         *  Constructor. Creates an empty pattern.
+         *  @param rows is the number of rows (notes).
+         *  @param stepCount is the number of steps in each row.
+         */
+        Pattern(const int rows = 0, const int stepCount = 0);
+        
+        /** Destructor. */
+        ~Pattern();
+        
+        /**
+         *  Resizes the pattern, clearing every step.
+         *  @param rows is the number of rows (notes).
+         *  @param stepCount is the number of steps in each row.
+         */
+        void setSize(const int rows, const int stepCount);
+        
+        /** Getter for the number of rows. */
+        int getNumRows() const { return numRows; }
+        
+        /** Getter for the number of steps. */
+        int getNumSteps() const { return numSteps; }
+        
+        /**
+         *  Turns a step on or off.
+         *  @param row is the row index of the step.
+         *  @param step is the column index of the step.
+         *  @param state is true for an active step.
+         */
+        void setStep(const int row, const int step, const bool state);
+        
+        /**
+         *  Returns the state of a step.
+         *  @param row is the row index of the step.
+         *  @param step is the column index of the step.
+         *  @return true if the step is active.
+         */
+        bool getStep(const int row, const int step) const;
+        
+        /**
+         *  Accessor for every row on a step.
+         *  @param the column index of the step.
+         *  @return the bits for each row on that step.
+         */
+        const StepMask& getStepMask(const int step) const;
+        
+        /**
+         *  Accessor for every step at once, for writing out as a block.
+         *  @return the first of getNumSteps() contiguous step masks.
+         */
+        const StepMask* getData() const { return steps.getRawDataPointer(); }
+        
+        /**
+         *  Copies steps in as a block. Steps or rows beyond the size of the
+         *  pattern are dropped, steps not covered are cleared.
+         *  @param source is the first of the step masks to be copied.
+         *  @param stepCount is the number of step masks at source.
+         */
+        void copyFrom(const StepMask* source, const int stepCount);
+        
+        //======================================================================
+        
+        /** Turns every step off, a whole step mask at a time. */
+        void clear();
+        
+        /**
+         *  Rotates the steps in time, steps pushed off the end wrap around.
+         *  @param amount is the number of steps later, or earlier if negative.
+         */
+        void rotate(const int amount);
+        
+        /**
+         *  Moves every step up or down rows, rows pushed off the grid are dropped.
+         *  @param amount is the number of rows up, or down if negative.
+         */
+        void shiftRows(const int amount);
+        
+        /** Turns every step that is off on, and every step that is on off. */
+        void invert();
+        
+        /**
+         *  Turns rows on every nth step, leaving other steps as they are.
+         *  @param rows is the rows to be turned on, rows outside the pattern are ignored.
+         *  @param interval is the number of steps between each one turned on.
+         *  @param offset is the first step turned on.
+         */
+        void fillEvery(const StepMask& rows, const int interval, const int offset = 0);
+        
+        /**
+         *  Builds the mask of every row in use.
+         *  @return the bits for rows 0 to getNumRows() - 1.
+         */
+        StepMask getRowMask() const;
+        
+        /**
+         *  Builds the mask of a single row.
+         *  @param the row index.
+         *  @return a mask with only that row's bit set.
+         */
+        static StepMask getSingleRowMask(const int row);
+        
+        //======================================================================
+        
+        /**
+         *  Finds the next step with any row active, skipping empty steps
+         *  several at a time with SIMD compares.
+         *  @param the step to start searching from.
+         *  @return the next active step, or the number of steps if none.
+         */
+        int findNextActiveStep(int step) const;
+        
+        /**
+         *  Counts every active (row, step).
+         *  @return the number of set bits.
+         */
+        int getNumActiveSteps() const;
+        
+        /**
+         *  Calls back for every row active on a step, lowest row first.
+         *  @param step is the column index of the step.
+         *  @param callback is called with each active row index.
+         */
+        template <typename Callback>
+        void forEachActiveRow(const int step, Callback&& callback) const
+        {
+            forEachRowIn(getStepMask(step), callback);
+        }
+        
+        /**
+         *  Calls back for every row set in a mask, lowest row first.
+         *  @param mask is the rows to visit.
+         *  @param callback is called with each set row index.
+         */
+        template <typename Callback>
+        static void forEachRowIn(const StepMask& mask, Callback&& callback)
+        {
+            for(int word = 0; word < 2; ++word)
+            {
+                // set bit iteration, clearing the lowest bit each time
+                for(uint64 bits = mask.bits[word]; bits != 0; bits &= bits - 1)
+                    callback(word * 64 + countTrailingZeros(bits));
+            }
+        }
+        
+        /**
+         *  Calls back for every active (step, row) in time order.
+         *  @param callback is called with each active step & row index.
+         */
+        template <typename Callback>
+        void forEachActiveStep(Callback&& callback) const
+        {
+            for(int step = findNextActiveStep(0); step < numSteps; step = findNextActiveStep(step + 1))
+                forEachActiveRow(step, [&] (const int row) { callback(step, row); });
+        }
+        
+        /**
+         *  Index of the lowest set bit.
+         *  @param a non zero word.
+         *  @return the number of zero bits below the lowest set bit.
+         */
+        static int countTrailingZeros(const uint64 bits)
+        {
+            // there is no set bit to find!!!
+            jassert(bits != 0);
+           
+           #if defined(_MSC_VER) && defined(_WIN64)
+            unsigned long index;
+            _BitScanForward64(&index, bits);
+            return (int)index;
+           #elif defined(_MSC_VER)
+            unsigned long index;
+            if(_BitScanForward(&index, (unsigned long)bits))
+                return (int)index;
+            _BitScanForward(&index, (unsigned long)(bits >> 32));
+            return (int)index + 32;
+           #else
+            return __builtin_ctzll(bits);
+           #endif
+        }
+    
+    private:
+        /** Every step in time order. */
+        Array<StepMask> steps;
+        /** The number of rows in use. */
+        int numRows;
+        /** The number of steps in use. */
+        int numSteps;
+    };
+    
+} //namespace audio
@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    PatternHistory.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "PatternHistory.h"
+
+namespace audio
+{
+    PatternHistory::PatternHistory()
+    {
+        reset(Pattern());
+    }
+    
+    PatternHistory::~PatternHistory(){}
+    
+    //==========================================================================
+    
+    void PatternHistory::reset(const Pattern& pattern)
+    {
+        numRows = pattern.getNumRows();
+        numSteps = pattern.getNumSteps();
+        
+        versions.clear();
+        versions.add(makeSnapshot(pattern, nullptr));
+        currentVersion = 0;
+    }
+    
+    void PatternHistory::recordStep(const int row, const int step, const bool state)
+    {
+        // the step you are recording is outside the pattern!!!
+        jassert(row >= 0 && row < numRows && step >= 0 && step < numSteps);
+        
+        const int leafIndex = step / STEPS_PER_LEAF;
+        const int branchIndex = leafIndex / LEAVES_PER_BRANCH;
+        const Snapshot& current = versions.getReference(currentVersion);
+        
+        // copy only the changed leaf and the branch leading to it
+        auto leaf = std::make_shared<Leaf>(*current.branches[branchIndex]->leaves[leafIndex % LEAVES_PER_BRANCH]);
+        uint64& word = leaf->steps[step % STEPS_PER_LEAF].bits[row >> 6];
+        const uint64 bit = (uint64)1 << (row & 63);
+        word = state ? (word | bit) : (word & ~bit);
+        
+        auto branch = std::make_shared<Branch>(*current.branches[branchIndex]);
+        branch->leaves[leafIndex % LEAVES_PER_BRANCH] = leaf;
+        
+        Snapshot snapshot = current;
+        snapshot.branches.set(branchIndex, branch);
+        push(snapshot);
+    }
+    
+    void PatternHistory::recordPattern(const Pattern& pattern)
+    {
+        // the pattern has been resized, the history must be reset!!!
+        jassert(pattern.getNumRows() == numRows && pattern.getNumSteps() == numSteps);
+        
+        push(makeSnapshot(pattern, &versions.getReference(currentVersion)));
+    }
+    
+    //==========================================================================
+    
+    bool PatternHistory::undo()
+    {
+        if(canUndo() == false)
+            return false;
+        
+        --currentVersion;
+        return true;
+    }
+    
+    bool PatternHistory::redo()
+    {
+        if(canRedo() == false)
+            return false;
+        
+        ++currentVersion;
+        return true;
+    }
+    
+    void PatternHistory::copyCurrentTo(Pattern& pattern) const
+    {
+        // the pattern has been resized, the history must be reset!!!
+        jassert(pattern.getNumRows() == numRows && pattern.getNumSteps() == numSteps);
+        
+        const Snapshot& current = versions.getReference(currentVersion);
+        
+        // gather the leaves back into one contiguous block
+        HeapBlock<StepMask> steps ((size_t)jmax(1, numSteps));
+        for(int step = 0; step < numSteps; step += STEPS_PER_LEAF)
+        {
+            const int leafIndex = step / STEPS_PER_LEAF;
+            const Leaf& leaf = *current.branches[leafIndex / LEAVES_PER_BRANCH]->leaves[leafIndex % LEAVES_PER_BRANCH];
+            memcpy(steps + step, leaf.steps, sizeof(StepMask) * (size_t)jmin(STEPS_PER_LEAF, numSteps - step));
+        }
+        
+        pattern.copyFrom(steps, numSteps);
+    }
+    
+    //==========================================================================
+    
+    PatternHistory::Snapshot PatternHistory::makeSnapshot(const Pattern& pattern, const Snapshot* previous) const
+    {
+        const int numLeaves = (numSteps + STEPS_PER_LEAF - 1) / STEPS_PER_LEAF;
+        const int numBranches = (numLeaves + LEAVES_PER_BRANCH - 1) / LEAVES_PER_BRANCH;
+        Snapshot snapshot;
+        
+        for(int branchIndex = 0; branchIndex < numBranches; ++branchIndex)
+        {
+            auto branch = std::make_shared<Branch>();
+            bool sharesEveryLeaf = previous != nullptr;
+            
+            for(int i = 0; i < LEAVES_PER_BRANCH; ++i)
+            {
+                const int leafIndex = branchIndex * LEAVES_PER_BRANCH + i;
+                
+                // pad the last leaf with empty steps
+                Leaf leaf;
+                zerostruct(leaf);
+                for(int step = 0; step < STEPS_PER_LEAF; ++step)
+                {
+                    const int index = leafIndex * STEPS_PER_LEAF + step;
+                    if(index < numSteps)
+                        leaf.steps[step] = pattern.getStepMask(index);
+                }
+                
+                // share the previous version's leaf if nothing in it changed
+                const std::shared_ptr<const Leaf>* shared = previous != nullptr
+                    ? &previous->branches.getReference(branchIndex)->leaves[i] : nullptr;
+                
+                if(shared != nullptr && *shared != nullptr && memcmp(shared->get(), &leaf, sizeof(Leaf)) == 0)
+                {
+                    branch->leaves[i] = *shared;
+                }
+                else
+                {
+                    branch->leaves[i] = std::make_shared<Leaf>(leaf);
+                    sharesEveryLeaf = false;
+                }
+            }
+            
+            // an unchanged branch is shared whole
+            if(sharesEveryLeaf)
+                snapshot.branches.add(previous->branches[branchIndex]);
+            else
+                snapshot.branches.add(branch);
+        }
+        
+        return snapshot;
+    }
+    
+    void PatternHistory::push(const Snapshot& snapshot)
+    {
+        // forget anything that could have been redone
+        versions.removeRange(currentVersion + 1, versions.size() - currentVersion - 1);
+        
+        versions.add(snapshot);
+        currentVersion = versions.size() - 1;
+    }
+    
+} //namespace audio
@@ -0,0 +1,139 @@
+/**
+ *  @file    PatternHistory.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Unlimited undo & redo of pattern edits, built on structurally shared
+ *  pattern snapshots.
+ *
+ */
+
+#pragma once
+
+#include "Pattern.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  Unlimited undo & redo of pattern edits. Every version of the pattern is
+     *  kept as an immutable snapshot, a two level tree of 16 step leaves.
+     *  Versions share every leaf they have in common, so an edit only costs
+     *  the leaf it changed plus a path back to the root, however large the
+     *  pattern or long the history.
+     */
+    class PatternHistory
+    {
+    public:
+        /** Steps held in each leaf of a snapshot. */
+        static const int STEPS_PER_LEAF = 16;
+        /** Leaves held in each branch of a snapshot. */
+        static const int LEAVES_PER_BRANCH = 32;
+        
+        /** Constructor. Starts with an empty history. */
+        PatternHistory();
+        
+        /** Destructor. */
+        ~PatternHistory();
+        
+        /**
+         *  Clears the history, starting again from a pattern.
+         *  @param the pattern as it is now.
+         */
+        void reset(const Pattern& pattern);
+        
+        /**
+         *  Records a single step being changed as a new version.
+         *  Anything that could have been redone is forgotten.
+         *  @param row is the row index of the step.
+         *  @param step is the column index of the step.
+         *  @param state is the new state of the step.
+         */
+        void recordStep(const int row, const int step, const bool state);
+        
+        /**
+         *  Records a whole pattern as a new version, e.g. after an import.
+         *  Only the leaves that differ from the current version are stored.
+         *  @param the pattern as it is now.
+         */
+        void recordPattern(const Pattern& pattern);
+        
+        /** Checks if there is an edit to be undone. */
+        bool canUndo() const { return currentVersion > 0; }
+        
+        /** Checks if there is an undone edit to be redone. */
+        bool canRedo() const { return currentVersion < versions.size() - 1; }
+        
+        /**
+         *  Steps back to the previous version.
+         *  @return true if there was an edit to undo.
+         */
+        bool undo();
+        
+        /**
+         *  Steps forward to the next version.
+         *  @return true if there was an edit to redo.
+         */
+        bool redo();
+        
+        /**
+         *  Writes the current version into a pattern.
+         *  @param the pattern to be overwritten, it must be the same size.
+         */
+        void copyCurrentTo(Pattern& pattern) const;
+    
+    private:
+        /** Immutable block of steps. */
+        struct Leaf
+        {
+            /** The steps in this block. */
+            StepMask steps[STEPS_PER_LEAF];
+        };
+        
+        /** Immutable block of shared leaves. */
+        struct Branch
+        {
+            /** The leaves in this block. */
+            std::shared_ptr<const Leaf> leaves[LEAVES_PER_BRANCH];
+        };
+        
+        /** A single immutable version of the pattern. */
+        struct Snapshot
+        {
+            /** The shared branches making up the pattern. */
+            Array<std::shared_ptr<const Branch>> branches;
+        };
+        
+        /**
+         *  Builds a snapshot from a pattern, sharing any leaf equal to the
+         *  same leaf of another snapshot.
+         *  @param pattern is the pattern to be stored.
+         *  @param previous is the snapshot to share leaves with, or nullptr.
+         *  @return the new snapshot.
+         */
+        Snapshot makeSnapshot(const Pattern& pattern, const Snapshot* previous) const;
+        
+        /**
+         *  Adds a new version after the current one, dropping any redo.
+         *  @param the new snapshot.
+         */
+        void push(const Snapshot& snapshot);
+        
+        /** Every version, oldest first. */
+        Array<Snapshot> versions;
+        /** The index of the current version. */
+        int currentVersion;
+        /** The number of rows in the pattern. */
+        int numRows;
+        /** The number of steps in the pattern. */
+        int numSteps;
+        
+        JUCE_DECLARE_NON_COPYABLE (PatternHistory)
+    };
+    
+} //namespace audio
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+    PlaybackSchedule.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "PlaybackSchedule.h"
+#include "MidiWire.h"
+
+namespace audio
+{
+    PlaybackSchedule::PlaybackSchedule(const MidiEventList& eventList,
+                                       const int lengthInSteps,
+                                       const int ticksPerStepParam)
+    {
+        // the event list is already placed on the time line in ticks!!!
+        jassert(eventList.getTicksPerStep() == ticksPerStepParam);
+        
+        ticksPerStep = ticksPerStepParam;
+        lengthInTicks = (uint32)jmax(0, lengthInSteps) * (uint32)ticksPerStep;
+        numEvents = 0;
+        events.malloc((size_t)jmax(1, eventList.getSize()));
+        
+        for(int i = 0; i < eventList.getSize(); ++i)
+        {
+            const MidiMessage event = eventList.getMidiEvent(i);
+            
+            // only short messages can be packed, sysex is skipped!!!
+            jassert(event.getRawDataSize() <= 3);
+            if(event.getRawDataSize() > 3)
+                continue;
+            
+            ScheduledEvent& scheduled = events[numEvents++];
+            scheduled.tick = (uint32)jmax(0, roundToInt(event.getTimeStamp()));
+            scheduled.message = packMessage(event);
+        }
+    }
+    
+    PlaybackSchedule::PlaybackSchedule(const PlaybackSchedule& source,
+                                       const ScheduledEvent& noteOn,
+                                       const ScheduledEvent& noteOff,
+                                       const bool state)
+    {
+        ticksPerStep = source.ticksPerStep;
+        lengthInTicks = source.lengthInTicks;
+        numEvents = 0;
+        events.malloc((size_t)(source.numEvents + 2));
+        
+        // the note on comes before its note off
+        ScheduledEvent added[2];
+        int numAdded = 0;
+        if(state)
+        {
+            added[numAdded++] = noteOn;
+            added[numAdded++] = noteOff;
+        }
+        
+        // the order a compile places events sharing a tick in, note offs then notes from the lowest
+        auto comesBefore = [] (const ScheduledEvent& a, const ScheduledEvent& b)
+        {
+            if(a.tick != b.tick)
+                return a.tick < b.tick;
+            
+            const int priorityA = MidiWireEncoder::getPriority(a.message);
+            const int priorityB = MidiWireEncoder::getPriority(b.message);
+            if(priorityA != priorityB)
+                return priorityA < priorityB;
+            
+            return a.getData1() < b.getData1();
+        };
+        
+        // a single pass over the source, splicing the step in or out
+        bool removedOn = state;
+        bool removedOff = state;
+        int next = 0;
+        for(int i = 0; i < source.numEvents; ++i)
+        {
+            const ScheduledEvent& event = source.events[i];
+            
+            while(next < numAdded && comesBefore(added[next], event))
+                events[numEvents++] = added[next++];
+            
+            // the same events a compile would no longer place, one note on & one note off
+            if(removedOn == false && event.tick == noteOn.tick && event.message == noteOn.message)
+            {
+                removedOn = true;
+                continue;
+            }
+            
+            if(removedOff == false && event.tick == noteOff.tick && event.message == noteOff.message)
+            {
+                removedOff = true;
+                continue;
+            }
+            
+            events[numEvents++] = event;
+        }
+        
+        while(next < numAdded)
+            events[numEvents++] = added[next++];
+    }
+    
+    PlaybackSchedule::~PlaybackSchedule(){}
+    
+    //==========================================================================
+    
+    int PlaybackSchedule::getFirstEventAt(const uint32 tick) const
+    {
+        const ScheduledEvent* first = std::lower_bound(events.get(), events.get() + numEvents, tick,
+                                                       [] (const ScheduledEvent& event, const uint32 t)
+                                                       {
+                                                           return event.tick < t;
+                                                       });
+        return (int)(first - events.get());
+    }
+    
+    uint32 PlaybackSchedule::packMessage(const MidiMessage& midiMessage)
+    {
+        const uint8* data = midiMessage.getRawData();
+        uint32 packed = 0;
+        
+        for(int i = 0; i < jmin(3, midiMessage.getRawDataSize()); ++i)
+            packed |= (uint32)data[i] << (8 * i);
+        
+        return packed;
+    }
+    
+} //namespace audio
@@ -0,0 +1,145 @@
+/**
+ *  @file    PlaybackSchedule.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  The pattern compiled into a flat array of packed midi events for playback.
+ *
+ */
+
+#pragma once
+
+#include "MidiEventList.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  A single short midi message packed alongside its time in ticks.
+     *  8 bytes, so a whole pattern sits in a handful of cache lines.
+     */
+    struct ScheduledEvent
+    {
+        /** The time of the event in ticks from the start of the loop. */
+        uint32 tick;
+        /** The status byte, then each data byte, packed from the lowest byte. */
+        uint32 message;
+        
+        /** Accessor for the status byte. */
+        uint8 getStatus() const { return (uint8)(message & 0xff); }
+        /** Accessor for the first data byte (the note number). */
+        uint8 getData1() const { return (uint8)((message >> 8) & 0xff); }
+        /** Accessor for the second data byte (the velocity). */
+        uint8 getData2() const { return (uint8)((message >> 16) & 0xff); }
+        
+        /**
+         *  Unpacks the event for sending, no heap allocation is involved.
+         *  @return the midi message, without a time stamp.
+         */
+        MidiMessage toMidiMessage() const
+        {
+            return MidiMessage(getStatus(), getData1(), getData2());
+        }
+    };
+    
+    //==========================================================================
+    
+    /**
+     *  The pattern compiled into a flat array of packed midi events.
+     *  Built once per pattern change, then only ever read.
+     */
+    class PlaybackSchedule
+    {
+    public:
+        /**
+         *  Constructor. Compiles the event list into packed events.
+         *  @param eventList is the pattern being edited.
+         *  @param lengthInSteps is the number of steps before the loop wraps.
+         *  @param ticksPerStep is the resolution the event list is time stamped at.
+         */
+        PlaybackSchedule(const MidiEventList& eventList,
+                         const int lengthInSteps,
+                         const int ticksPerStep);
+        
+        /**
+         *  Constructor. Copies a schedule with a single step turned on or off,
+         *  so an edit is patched in without compiling the whole pattern. The
+         *  step's events are spliced into place, nothing is sorted. The
+         *  result holds exactly the events a recompile would.
+         *
+         *  @param source is the schedule being replaced.
+         *  @param noteOn is the note on of the step.
+         *  @param noteOff is the note off of the step.
+         *  @param state is true if the step was turned on.
+         */
+        PlaybackSchedule(const PlaybackSchedule& source,
+                         const ScheduledEvent& noteOn,
+                         const ScheduledEvent& noteOff,
+                         const bool state);
+        
+        /** Destructor. */
+        ~PlaybackSchedule();
+        
+        /**
+         *  Returns the number of events in the schedule.
+         *  @return the number of events.
+         */
+        int getNumEvents() const { return numEvents; }
+        
+        /**
+         *  Returns the event at an index, by reference.
+         *  @param the index of the event.
+         *  @return the packed event.
+         */
+        const ScheduledEvent& getEvent(const int index) const
+        {
+            // the index you are getting is out of range!!!
+            jassert(index >= 0 && index < numEvents);
+            
+            return events[index];
+        }
+        
+        /**
+         *  Returns the length of the loop.
+         *  @return the length in ticks.
+         */
+        uint32 getLengthInTicks() const { return lengthInTicks; }
+        
+        /** Getter for the ticks in each sequencer step. */
+        int getTicksPerStep() const { return ticksPerStep; }
+        
+        /**
+         *  Finds the first event at or after a tick, by binary search.
+         *  @param the tick to search from.
+         *  @return the index of the event, or the number of events if none.
+         */
+        int getFirstEventAt(const uint32 tick) const;
+        
+        /**
+         *  Packs a short midi message.
+         *  @param the message to be packed, it must be 3 bytes or less.
+         *  @return the status and data bytes packed from the lowest byte.
+         */
+        static uint32 packMessage(const MidiMessage& midiMessage);
+    
+    private:
+        /** Private constructor. Must provide a pattern! */
+        PlaybackSchedule();
+        
+        /** Contiguous array of every event in time order. */
+        HeapBlock<ScheduledEvent> events;
+        /** The number of events in the array. */
+        int numEvents;
+        /** The length of the loop in ticks. */
+        uint32 lengthInTicks;
+        /** The ticks in each sequencer step. */
+        int ticksPerStep;
+        
+        JUCE_DECLARE_NON_COPYABLE (PlaybackSchedule)
+    };
+    
+} //namespace audio
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    PlaybackSettings.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "PlaybackSettings.h"
+
+namespace audio
+{
+    PlaybackSettings::PlaybackSettings()
+    {
+        for(int i = 0; i < numSettings; ++i)
+            values[i].set(0.0f);
+    }
+    
+    PlaybackSettings::~PlaybackSettings(){}
+    
+    //==========================================================================
+    
+    void PlaybackSettings::set(const Setting setting, const float value)
+    {
+        // the setting you are changing does not exist!!!
+        jassert(setting >= 0 && setting < numSettings);
+        
+        if(values[setting].exchange(value) == value)
+            return; // unchanged, nobody needs telling
+        
+        for(int i = listeners[setting].size(); --i >= 0;)
+            listeners[setting].getUnchecked(i)->playbackSettingChanged(setting, value);
+    }
+    
+    void PlaybackSettings::addListener(const Setting setting, Listener* listener)
+    {
+        listeners[setting].addIfNotAlreadyThere(listener);
+    }
+    
+    void PlaybackSettings::removeListener(const Setting setting, Listener* listener)
+    {
+        listeners[setting].removeFirstMatchingValue(listener);
+    }
+    
+} //namespace audio
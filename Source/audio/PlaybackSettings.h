@@ -0,0 +1,105 @@
+/**
+ *  @file    PlaybackSettings.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Typed playback settings, each an atomic field with its own listeners.
+ *
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  The playback settings, indexed by an enum rather than looked up by
+     *  name. Reading a setting is a single atomic load from any thread.
+     *  Settings are changed on the message thread, and only the listeners
+     *  of the setting that changed are told.
+     */
+    class PlaybackSettings
+    {
+    public:
+        /** Every playback setting. */
+        enum Setting
+        {
+            tempo = 0,      ///< quarter notes per minute
+            velocity,       ///< velocity of every step
+            startNote,      ///< note number of the bottom row
+            rowCount,       ///< rows (notes) in the grid
+            columnCount,    ///< steps in each row
+            noteMode,       ///< a MidiEventList::NoteMode, 1 merges runs of steps into one note
+            swing,          ///< fraction of a step every other step is delayed, 0 to 0.75
+            compactOutput,  ///< 1 sends note offs as note ons of velocity 0, for running status
+            numSettings
+        };
+        
+        /**
+         *  Listener for changes to a setting.
+         */
+        class Listener
+        {
+        public:
+            /** Virtual destructor. */
+            virtual ~Listener(){}
+            
+            /**
+             *  Alerts when a setting this listener subscribed to has changed.
+             *  @param setting is the setting that changed.
+             *  @param value is its new value.
+             */
+            virtual void playbackSettingChanged(const Setting setting, const float value) = 0;
+        };
+        
+        /** Constructor. Every setting starts at zero. */
+        PlaybackSettings();
+        
+        /** Destructor. */
+        ~PlaybackSettings();
+        
+        /**
+         *  Reads a setting, safe from any thread.
+         *  @param the setting to be read.
+         *  @return its value.
+         */
+        float get(const Setting setting) const { return values[setting].get(); }
+        
+        /**
+         *  Changes a setting, then tells its listeners if the value differs.
+         *  Message thread only.
+         *  @param setting is the setting to be changed.
+         *  @param value is its new value.
+         */
+        void set(const Setting setting, const float value);
+        
+        /**
+         *  Subscribes a listener to changes of one setting.
+         *  @param setting is the setting to be listened to.
+         *  @param listener is the listener to be added.
+         */
+        void addListener(const Setting setting, Listener* listener);
+        
+        /**
+         *  Unsubscribes a listener from one setting.
+         *  @param setting is the setting listened to.
+         *  @param listener is the listener to be removed.
+         */
+        void removeListener(const Setting setting, Listener* listener);
+    
+    private:
+        /** The value of each setting. */
+        Atomic<float> values[numSettings];
+        /** The listeners of each setting, message thread only. */
+        Array<Listener*> listeners[numSettings];
+        
+        JUCE_DECLARE_NON_COPYABLE (PlaybackSettings)
+    };
+    
+} //namespace audio
@@ -0,0 +1,189 @@
+/*
+  ==============================================================================
+
+    ProjectFile.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "ProjectFile.h"
+
+namespace audio
+{
+    static_assert(sizeof(ProjectHeader) == 64, "the header layout is part of the file format");
+    static_assert(sizeof(StepMask) == 16, "the step layout is part of the file format");
+    static_assert(sizeof(ChainEntry) == 8, "the chain layout is part of the file format");
+    
+    ProjectFile::ProjectFile(const File& file)
+    {
+        header = nullptr;
+        mappedFile = std::make_unique<MemoryMappedFile>(file, MemoryMappedFile::readOnly);
+        
+        const char* data = static_cast<const char*>(mappedFile->getData());
+        const size_t size = mappedFile->getSize();
+        
+        if(data == nullptr || size < sizeof(ProjectHeader))
+            return; // missing or truncated
+        
+        const ProjectHeader* candidate = reinterpret_cast<const ProjectHeader*>(data);
+        
+        if(memcmp(candidate->magic, "SSQP", 4) != 0
+           || candidate->byteOrder != BYTE_ORDER_MARK
+           || candidate->version < 1
+           || candidate->version > CURRENT_VERSION
+           || candidate->fileSize != size
+           || candidate->numRows == 0
+           || candidate->numRows > (uint32)Pattern::MAX_ROWS
+           || candidate->numSteps == 0
+           || candidate->numSteps > (uint32)Pattern::MAX_STEPS
+           || candidate->noteMode > (uint32)MidiEventList::legato
+           || candidate->numPatterns == 0
+           || candidate->numPatterns > (uint32)Song::MAX_PATTERNS)
+            return; // not a project we can read
+        
+        // every section starts on the boundary it was written at
+        if(candidate->settingsOffset != align(candidate->settingsOffset)
+           || candidate->chainOffset != align(candidate->chainOffset)
+           || candidate->patternOffset != align(candidate->patternOffset))
+            return;
+        
+        // and must lie inside the file
+        const uint64 settingsEnd = (uint64)candidate->settingsOffset + getSettingsSize(candidate->version);
+        const uint64 chainEnd = (uint64)candidate->chainOffset + (uint64)candidate->chainLength * sizeof(ChainEntry);
+        const uint64 patternEnd = (uint64)candidate->patternOffset
+                                    + (uint64)candidate->numPatterns * candidate->numSteps * sizeof(StepMask);
+        
+        if(settingsEnd > size || chainEnd > size || patternEnd > size)
+            return;
+        
+        // and the chain must only refer to patterns in the file
+        const ChainEntry* chain = reinterpret_cast<const ChainEntry*>(data + candidate->chainOffset);
+        for(uint32 i = 0; i < candidate->chainLength; ++i)
+        {
+            if(chain[i].pattern < 0 || (uint32)chain[i].pattern >= candidate->numPatterns || chain[i].repeats < 1)
+                return;
+        }
+        
+        header = candidate;
+    }
+    
+    ProjectFile::~ProjectFile(){}
+    
+    //==========================================================================
+    
+    ProjectSettings ProjectFile::getSettings() const
+    {
+        // the project is not valid!!!
+        jassert(isValid());
+        
+        // what version 2 added comes last, so an older file's settings are a prefix
+        ProjectSettings settings;
+        zerostruct(settings);
+        for(int row = 0; row < Pattern::MAX_ROWS; ++row)
+            settings.rowBus[row] = row;
+        
+        const char* data = reinterpret_cast<const char*>(header);
+        memcpy(&settings, data + header->settingsOffset, getSettingsSize(header->version));
+        
+        // keep an edited or damaged file within the ranges the interface allows
+        auto limit = [] (const float value, const float low, const float high, const float fallback)
+        {
+            return std::isfinite(value) ? jlimit(low, high, value) : fallback;
+        };
+        settings.tempo = limit(settings.tempo, 30.0f, 300.0f, 120.0f);
+        settings.velocity = limit(settings.velocity, 1.0f, 127.0f, 98.0f);
+        settings.startNote = jlimit(0, 127, (int)settings.startNote);
+        settings.oscillator = jlimit(1, 5, (int)settings.oscillator);
+        settings.filterCutoff = limit(settings.filterCutoff, 20.0f, 19999.0f, 19999.0f);
+        return settings;
+    }
+    
+    const ChainEntry* ProjectFile::getChain() const
+    {
+        // the project is not valid!!!
+        jassert(isValid());
+        
+        const char* data = reinterpret_cast<const char*>(header);
+        return reinterpret_cast<const ChainEntry*>(data + header->chainOffset);
+    }
+    
+    const StepMask* ProjectFile::getPatternSteps(const int pattern) const
+    {
+        // the project is not valid, or the pattern is out of range!!!
+        jassert(isValid() && pattern >= 0 && (uint32)pattern < header->numPatterns);
+        
+        const char* data = reinterpret_cast<const char*>(header);
+        const size_t patternSize = header->numSteps * sizeof(StepMask);
+        return reinterpret_cast<const StepMask*>(data + header->patternOffset + pattern * patternSize);
+    }
+    
+    size_t ProjectFile::getSettingsSize(const uint32 version)
+    {
+        if(version < 2)
+            return offsetof(ProjectSettings, rowBus) + 16 * sizeof(int32);
+        
+        return sizeof(ProjectSettings);
+    }
+    
+    //==========================================================================
+    
+    bool ProjectFile::save(const File& file, const Song& song, const ProjectSettings& settings)
+    {
+        const Song::Chain chain = song.getChain();
+        const int numPatterns = song.getNumPatterns();
+        const Pattern first = song.getPattern(0);
+        
+        // lay out each section after the header
+        ProjectHeader header;
+        zerostruct(header);
+        memcpy(header.magic, "SSQP", 4);
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.version = CURRENT_VERSION;
+        header.numRows = (uint32)first.getNumRows();
+        header.numSteps = (uint32)first.getNumSteps();
+        header.numPatterns = (uint32)numPatterns;
+        header.noteMode = (uint32)song.getNoteMode();
+        header.chainLength = (uint32)chain.size();
+        header.settingsOffset = align(sizeof(ProjectHeader));
+        header.chainOffset = align(header.settingsOffset + sizeof(ProjectSettings));
+        header.patternOffset = align(header.chainOffset + header.chainLength * sizeof(ChainEntry));
+        header.fileSize = header.patternOffset + header.numPatterns * header.numSteps * sizeof(StepMask);
+        
+        // written beside the target, then renamed over it once complete
+        TemporaryFile temporary (file);
+        
+        {
+            FileOutputStream out (temporary.getFile());
+            if(out.failedToOpen())
+                return false;
+            
+            bool ok = out.write(&header, sizeof(header));
+            
+            ok = ok && out.writeRepeatedByte(0, header.settingsOffset - (uint32)out.getPosition());
+            ok = ok && out.write(&settings, sizeof(settings));
+            
+            ok = ok && out.writeRepeatedByte(0, header.chainOffset - (uint32)out.getPosition());
+            ok = ok && out.write(chain.begin(), chain.size() * sizeof(ChainEntry));
+            
+            ok = ok && out.writeRepeatedByte(0, header.patternOffset - (uint32)out.getPosition());
+            for(int i = 0; ok && i < numPatterns; ++i)
+            {
+                const Pattern pattern = song.getPattern(i);
+                
+                // every pattern shares the grid size!!!
+                jassert((uint32)pattern.getNumSteps() == header.numSteps);
+                
+                ok = out.write(pattern.getData(), header.numSteps * sizeof(StepMask));
+            }
+            
+            out.flush();
+            if(ok == false || out.getStatus().failed())
+                return false;
+        }
+        
+        return temporary.overwriteTargetFileWithTemporary();
+    }
+    
+} //namespace audio
@@ -0,0 +1,169 @@
+/**
+ *  @file    ProjectFile.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Binary project file, laid out so it is memory mapped & read in place.
+ *
+ */
+
+#pragma once
+
+#include "Song.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  Playback & synthesiser settings, stored as is in a project file.
+     */
+    struct ProjectSettings
+    {
+        /** The playback tempo. */
+        float tempo;
+        /** The velocity of every step. */
+        float velocity;
+        /** The note number of the bottom row. */
+        int32 startNote;
+        /** The ID of the oscillator bank, @see Audio::setOscillator. */
+        int32 oscillator;
+        /** The LPF cutoff frequency. */
+        float filterCutoff;
+        /** Non zero when each row is rendered to its own bus. */
+        int32 stemRouting;
+        /** The bus each row is rendered to as a stem, version 1 only stored 16. */
+        int32 rowBus[Pattern::MAX_ROWS];
+        /** Non zero when note offs are sent as note ons of velocity 0, from version 2. */
+        int32 compactOutput;
+    };
+    
+    /**
+     *  The fixed header at the start of every project file. Each section is
+     *  found by its byte offset from the start of the file.
+     */
+    struct ProjectHeader
+    {
+        /** Always "SSQP". */
+        char magic[4];
+        /** BYTE_ORDER_MARK as written, so a file from another endianness is refused. */
+        uint32 byteOrder;
+        /** The format version the file was written with. */
+        uint32 version;
+        /** The size of the whole file in bytes. */
+        uint32 fileSize;
+        /** The number of rows in every pattern. */
+        uint32 numRows;
+        /** The number of steps in every pattern. */
+        uint32 numSteps;
+        /** The number of patterns. */
+        uint32 numPatterns;
+        /** The number of entries in the chain. */
+        uint32 chainLength;
+        /** Where the ProjectSettings are. */
+        uint32 settingsOffset;
+        /** Where the ChainEntry array is. */
+        uint32 chainOffset;
+        /** Where the StepMask array of each pattern is, one after another. */
+        uint32 patternOffset;
+        /** The MidiEventList::NoteMode of every pattern, zero (retrigger) in older files. */
+        uint32 noteMode;
+        /** Space for later versions, written as zero. */
+        uint32 reserved[4];
+    };
+    
+    //==========================================================================
+    
+    /**
+     *  A project file memory mapped for reading. Nothing is parsed, every
+     *  section is read in place once the header has been checked, so even
+     *  projects with hundreds of patterns load instantly.
+     */
+    class ProjectFile
+    {
+    public:
+        /** The version of the format written by save, 2 widened the row buses to every row. */
+        static const uint32 CURRENT_VERSION = 2;
+        /** Written to the header to detect the byte order. */
+        static const uint32 BYTE_ORDER_MARK = 0x01020304;
+        
+        /**
+         *  Constructor. Maps the file & checks the header.
+         *  @param the project file to be read.
+         */
+        ProjectFile(const File& file);
+        
+        /** Destructor. Unmaps the file. */
+        ~ProjectFile();
+        
+        /**
+         *  Checks the file was mapped and every section lies inside it.
+         *  @return true if the project can be read.
+         */
+        bool isValid() const { return header != nullptr; }
+        
+        /** Accessor for the header, the project must be valid. */
+        const ProjectHeader& getHeader() const { return *header; }
+        
+        /**
+         *  Getter for the settings, the project must be valid.
+         *  @return a copy of the settings, rows a version 1 file has no bus
+         *          for are given their own & values outside the ranges
+         *          the interface allows are clamped.
+         */
+        ProjectSettings getSettings() const;
+        
+        /**
+         *  Accessor for the chain, the project must be valid.
+         *  @return the first of chainLength entries.
+         */
+        const ChainEntry* getChain() const;
+        
+        /**
+         *  Accessor for a pattern's steps, the project must be valid.
+         *  @param the index of the pattern.
+         *  @return the first of numSteps step masks.
+         */
+        const StepMask* getPatternSteps(const int pattern) const;
+        
+        /**
+         *  Writes a project to a temporary file then swaps it in, so a crash
+         *  mid save never leaves a half written project behind.
+         *  @param file is where the project is saved.
+         *  @param song holds the patterns & chain to be saved.
+         *  @param settings are the playback & synthesiser settings.
+         *  @return true if the project was saved.
+         */
+        static bool save(const File& file, const Song& song, const ProjectSettings& settings);
+    
+    private:
+        /** Private constructor. Must provide a file! */
+        ProjectFile();
+        
+        /**
+         *  Rounds a byte offset up so each section is 16 byte aligned.
+         *  @param the offset to be aligned.
+         *  @return the aligned offset.
+         */
+        static uint32 align(const uint32 offset) { return (offset + 15) & ~(uint32)15; }
+        
+        /**
+         *  Finds the size of the settings section, which grew in version 2.
+         *  @param the format version of the file.
+         *  @return the size in bytes.
+         */
+        static size_t getSettingsSize(const uint32 version);
+        
+        /** The mapped file. */
+        std::unique_ptr<MemoryMappedFile> mappedFile;
+        /** The header at the start of the mapping, or nullptr if invalid. */
+        const ProjectHeader* header;
+        
+        JUCE_DECLARE_NON_COPYABLE (ProjectFile)
+    };
+    
+} //namespace audio
@@ -0,0 +1,426 @@
+/*
+  ==============================================================================
+
+    Sequencer.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "Sequencer.h"
+
+namespace audio
+{
+    Sequencer::Sequencer(std::unique_ptr<MidiOutput> output) : Thread("sequencer clock"),
+                                                               prefetcher(*this)
+    {
+        numPorts.set(0);
+        numTracks.set(0);
+        addPort(std::move(output));
+        lookahead.set(DEFAULT_LOOKAHEAD);
+        tempo.set(musicalClock.getTempo());
+        running.set(false);
+        clockWoken = false;
+        listener = nullptr;
+        
+        prefetcher.startThread();
+    }
+    
+    Sequencer::~Sequencer()
+    {
+        stop();
+        prefetcher.stopThread(1000);
+        
+        for(int i = 0; i < numTracks.get(); ++i)
+            tracks[i]->getSong().addListener(nullptr);
+    }
+    
+    //==========================================================================
+    
+    int Sequencer::addTrack()
+    {
+        const int index = numTracks.get();
+        
+        // the track slots are fixed so the clock can read them unlocked!!!
+        jassert(index < MAX_TRACKS);
+        
+        tracks[index] = std::make_unique<Track>();
+        tracks[index]->getSong().setTicksPerStep(musicalClock.getTicksPerStep());
+        tracks[index]->getSong().addListener(this);
+        
+        // the track is complete before the clock can see it
+        numTracks.set(index + 1);
+        return index;
+    }
+    
+    int Sequencer::addPort(std::unique_ptr<MidiOutput> device)
+    {
+        const int index = numPorts.get();
+        
+        // the port slots are fixed so the clock can read them unlocked!!!
+        jassert(index < MAX_PORTS);
+        
+        if(device == nullptr || index >= MAX_PORTS)
+            return -1;
+        
+        ports[index] = std::make_unique<MidiPort>(std::move(device));
+        
+        // the port is running before the clock can see it
+        numPorts.set(index + 1);
+        return index;
+    }
+    
+    MidiPort& Sequencer::getPort(const int index)
+    {
+        // the port you are getting is out of range!!!
+        jassert(index >= 0 && index < numPorts.get());
+        
+        return *ports[index];
+    }
+    
+    Track& Sequencer::getTrack(const int index)
+    {
+        // the track you are getting is out of range!!!
+        jassert(index >= 0 && index < numTracks.get());
+        
+        return *tracks[index];
+    }
+    
+    const Track& Sequencer::getTrack(const int index) const
+    {
+        // the track you are getting is out of range!!!
+        jassert(index >= 0 && index < numTracks.get());
+        
+        return *tracks[index];
+    }
+    
+    void Sequencer::setTempo(const double beatsPerMinute)
+    {
+        musicalClock.setTempo(beatsPerMinute);
+        tempo.set(musicalClock.getTempo());
+        wakeClock();
+    }
+    
+    void Sequencer::setPpq(const int ticksPerQuarterNote)
+    {
+        // the resolution can't change under the running clock!!!
+        jassert(running.get() == false);
+        
+        musicalClock.setPpq(ticksPerQuarterNote);
+        for(int i = 0; i < numTracks.get(); ++i)
+            tracks[i]->getSong().setTicksPerStep(musicalClock.getTicksPerStep());
+    }
+    
+    void Sequencer::setLookahead(const int milliseconds)
+    {
+        // the window must be at least a millisecond!!!
+        jassert(milliseconds >= 1);
+        
+        lookahead.set(jmax(1, milliseconds));
+        wakeClock();
+    }
+    
+    //==========================================================================
+    
+    void Sequencer::start()
+    {
+        if(running.get())
+            return;
+        
+        // the first patterns are compiled up front, the clock keeps its own time base
+        for(int i = 0; i < numTracks.get(); ++i)
+            tracks[i]->getSong().prepareToPlay();
+        
+        // a clock that stopped itself may still be on its way out
+        stopThread(1000);
+        
+        playbackClock = musicalClock;
+        running.set(true);
+        startThread(Thread::realtimeAudioPriority);
+    }
+    
+    void Sequencer::stop()
+    {
+        running.set(false);
+        signalThreadShouldExit();
+        wakeClock();
+        stopThread(1000);
+        
+        // drop anything still queued ahead, then release any held notes
+        uint16 channels = 0;
+        for(int i = 0; i < numTracks.get(); ++i)
+        {
+            const int channel = tracks[i]->getChannel();
+            channels |= channel > 0 ? (uint16)(1 << (channel - 1)) : tracks[i]->getSong().getChannelsUsed();
+        }
+        
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for(int i = 0; i < numPorts.get(); ++i)
+        {
+            ports[i]->clear();
+            
+            for(int channel = 1; channel <= 16; ++channel)
+                if((channels & (1 << (channel - 1))) != 0)
+                    ports[i]->push(now, PlaybackSchedule::packMessage(MidiMessage::allNotesOff(channel)));
+            
+            ports[i]->send();
+        }
+    }
+    
+    //==========================================================================
+    
+    void Sequencer::run()
+    {
+        typedef std::chrono::steady_clock Clock;
+        
+        // everything below is owned by the clock, every track starts from the top of its chain
+        timebase = { Clock::now(), 0 };
+        Clock::time_point renderedUntil = timebase.origin;
+        TrackCursor cursors[MAX_TRACKS];
+        Array<PendingEvent> events[MAX_TRACKS];
+        int heads[MAX_TRACKS];
+        
+        int knownTracks = numTracks.get();
+        for(int i = 0; i < MAX_TRACKS; ++i)
+        {
+            cursors[i] = { 0, 0, 0, 0 };
+            events[i].ensureStorageAllocated(256);
+        }
+        
+        while(threadShouldExit() == false)
+        {
+            const Clock::time_point now = Clock::now();
+            const Clock::duration window = std::chrono::milliseconds(lookahead.get());
+            const int trackCount = numTracks.get();
+            
+            // a new tempo takes over from the first tick not yet queued, so the position never jumps
+            const double newTempo = tempo.get();
+            if(newTempo != playbackClock.getTempo())
+            {
+                const uint64 firstUnrendered = (uint64)std::ceil(tickAt(renderedUntil));
+                timebase = { timeOf(firstUnrendered), firstUnrendered };
+                playbackClock.setTempo(newTempo);
+            }
+            
+            // tracks added while playing join at the next step
+            for(; knownTracks < trackCount; ++knownTracks)
+            {
+                const uint64 ticksPerStep = (uint64)playbackClock.getTicksPerStep();
+                const uint64 step = (uint64)std::ceil(tickAt(now) / (double)ticksPerStep);
+                cursors[knownTracks] = { step * ticksPerStep, 0, 0, 0 };
+            }
+            
+            // each track renders its own window, already in time order
+            Clock::time_point due = now + std::chrono::seconds(1);
+            bool anythingToPlay = false;
+            for(int i = 0; i < trackCount; ++i)
+            {
+                events[i].clearQuick();
+                heads[i] = 0;
+                
+                const Clock::time_point next = renderTrack(*tracks[i], cursors[i], now + window, events[i]);
+                anythingToPlay = anythingToPlay || next != Clock::time_point::max();
+                due = jmin(due, next);
+            }
+            
+            // every chain is empty, stop rather than keep waking with nothing to play
+            if(anythingToPlay == false)
+            {
+                running.set(false);
+                if(listener != nullptr)
+                    listener->playbackStopped();
+                return;
+            }
+            
+            renderedUntil = jmax(renderedUntil, now + window);
+            
+            // merge the tracks into one stream, each port's queue stays in time order
+            // & events due together go note offs first, across every track
+            auto comesBefore = [] (const PendingEvent& a, const PendingEvent& b)
+            {
+                if(a.time != b.time)
+                    return a.time < b.time;
+                
+                return MidiWireEncoder::getPriority(a.message) < MidiWireEncoder::getPriority(b.message);
+            };
+            
+            const int portCount = numPorts.get();
+            uint32 portsPushed = 0;
+            for(;;)
+            {
+                int earliest = -1;
+                for(int i = 0; i < trackCount; ++i)
+                {
+                    if(heads[i] < events[i].size()
+                       && (earliest < 0 || comesBefore(events[i].getReference(heads[i]), events[earliest].getReference(heads[earliest]))))
+                        earliest = i;
+                }
+                
+                if(earliest < 0)
+                    break;
+                
+                const PendingEvent& event = events[earliest].getReference(heads[earliest]++);
+                const int port = event.port < portCount ? event.port : 0;
+                
+                // a full queue means the device has fallen behind, the event is dropped!!!
+                const bool queued = ports[port]->push(event.time, event.message);
+                jassert(queued);
+                ignoreUnused(queued);
+                
+                portsPushed |= 1u << port;
+            }
+            
+            // each port's own thread sends its events at their times
+            for(int i = 0; i < portCount; ++i)
+                if((portsPushed & (1u << i)) != 0)
+                    ports[i]->send();
+            
+            // wake once the next event of any track comes into the window
+            waitForClock(due - window);
+        }
+    }
+    
+    std::chrono::steady_clock::time_point Sequencer::renderTrack(Track& track,
+                                                                 TrackCursor& cursor,
+                                                                 const std::chrono::steady_clock::time_point horizon,
+                                                                 Array<PendingEvent>& events)
+    {
+        Song& song = track.getSong();
+        const int channel = track.getChannel();
+        const uint32 velocity = (uint32)track.getVelocity();
+        
+        // every deadline is the whole number of ticks since playback started
+        auto timeOf = [this, &cursor] (const uint32 tick)
+        {
+            return this->timeOf(cursor.loopStartTick + tick);
+        };
+        
+        for(;;)
+        {
+            // pin the current chain & schedule, edits publish new ones rather than change them
+            Song::ChainPublisher::ScopedRead chain (song.getChainPublisher(), Song::PLAYBACK_READER);
+            if(chain.get() == nullptr || chain->isEmpty())
+                return std::chrono::steady_clock::time_point::max(); // nothing to play
+            
+            const ChainEntry& entry = chain->getReference(cursor.chainEntry % chain->size());
+            Song::SchedulePublisher::ScopedRead schedule (song.getSchedule(entry.pattern), Song::PLAYBACK_READER);
+            
+            // a pattern that was never compiled plays as a silent bar
+            const int numEvents = schedule.get() != nullptr ? schedule->getNumEvents() : 0;
+            const uint32 lengthInTicks = jmax((uint32)1, schedule.get() != nullptr
+                                                             ? schedule->getLengthInTicks()
+                                                             : (uint32)(song.getNumColumns() * playbackClock.getTicksPerStep()));
+            
+            // searched by tick rather than index, the schedule may have been replaced
+            int index = numEvents > 0 ? schedule->getFirstEventAt(cursor.nextTick) : 0;
+            
+            for(; index < numEvents && timeOf(schedule->getEvent(index).tick) <= horizon; ++index)
+            {
+                const ScheduledEvent& event = schedule->getEvent(index);
+                
+                // channel messages are moved onto the track's channel, unless the rows keep their own
+                uint32 message = (channel > 0 && event.getStatus() < 0xf0) ? ((event.message & ~(uint32)0x0f) | (uint32)(channel - 1))
+                                                                           : event.message;
+                
+                // note ons take the track's velocity now rather than when compiled
+                const uint8 type = event.getStatus() & 0xf0;
+                if(type == 0x90 && event.getData2() != 0)
+                    message = (message & ~(uint32)0xff0000) | (velocity << 16);
+                
+                // rows are routed to their own port by the channel & note they are mapped onto
+                const int port = (type == 0x80 || type == 0x90 || type == 0xa0) ? track.getPortForNote((event.getStatus() & 0x0f) + 1, event.getData1())
+                                                                                : track.getPort();
+                events.add({ timeOf(event.tick), message, port });
+                cursor.nextTick = event.tick + 1;
+            }
+            
+            if(index < numEvents)
+                return timeOf(schedule->getEvent(index).tick);
+            
+            if(timeOf(lengthInTicks) > horizon)
+                return timeOf(lengthInTicks);
+            
+            // the next loop starts exactly where this one ended, not when it was noticed
+            cursor.loopStartTick += lengthInTicks;
+            cursor.nextTick = 0;
+            
+            // move along the chain once the entry has repeated enough
+            if(++cursor.repeatCount >= entry.repeats)
+            {
+                cursor.repeatCount = 0;
+                cursor.chainEntry = (cursor.chainEntry + 1) % chain->size();
+                
+                // the next pattern is already compiled, prefetch the one after
+                song.setPlayingEntry(cursor.chainEntry);
+            }
+        }
+    }
+    
+    //==========================================================================
+    
+    std::chrono::steady_clock::time_point Sequencer::timeOf(const uint64 tick) const
+    {
+        // timed from the last tempo change rather than summed step by step, so nothing drifts
+        const std::chrono::nanoseconds offset (tick >= timebase.originTick
+                                               ? (int64)playbackClock.ticksToWholeNanoseconds(tick - timebase.originTick)
+                                               : -(int64)playbackClock.ticksToWholeNanoseconds(timebase.originTick - tick));
+        return timebase.origin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+    }
+    
+    double Sequencer::tickAt(const std::chrono::steady_clock::time_point time) const
+    {
+        const std::chrono::duration<double, std::nano> elapsed (time - timebase.origin);
+        return (double)timebase.originTick + elapsed.count() / playbackClock.getNanosecondsPerTick();
+    }
+    
+    void Sequencer::waitForClock(const std::chrono::steady_clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> clockLock (clockMutex);
+        clockCondition.wait_until(clockLock, deadline, [this] { return clockWoken || threadShouldExit(); });
+        clockWoken = false;
+    }
+    
+    void Sequencer::wakeClock()
+    {
+        {
+            const std::lock_guard<std::mutex> clockLock (clockMutex);
+            clockWoken = true;
+        }
+        clockCondition.notify_one();
+    }
+    
+    void Sequencer::scheduleCompiled(const int /*pattern*/)
+    {
+        // the clock rereads whichever schedules it is playing
+        wakeClock();
+    }
+    
+    void Sequencer::prefetchRequested()
+    {
+        prefetcher.notify();
+    }
+    
+    //==========================================================================
+    
+    Sequencer::Prefetcher::Prefetcher(Sequencer& owner) : Thread("pattern prefetch"),
+                                                          sequencer(owner)
+    {
+    }
+    
+    void Sequencer::Prefetcher::run()
+    {
+        while(threadShouldExit() == false)
+        {
+            wait(-1);
+            
+            if(threadShouldExit())
+                break;
+            
+            // cheap for any track with nothing stale
+            for(int i = 0; i < sequencer.getNumTracks(); ++i)
+                sequencer.getTrack(i).getSong().prefetch();
+        }
+    }
+    
+} //namespace audio
@@ -0,0 +1,296 @@
+/**
+ *  @file    Sequencer.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  The shared scheduler, playing every track from a single clock.
+ *
+ */
+
+#pragma once
+
+#include "Track.h"
+#include "MidiPort.h"
+#include "MusicalClock.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  The shared scheduler. A single clock thread plays every track, merging
+     *  their compiled schedules into one time ordered stream that is fanned
+     *  out to each output port's queue, and a single background thread
+     *  compiles whatever the tracks will play next. Adding a track adds to the
+     *  work of each wake, not another thread.
+     */
+    class Sequencer : private Thread,
+                      private Song::Listener
+    {
+    public:
+        /** The most tracks that can be played. */
+        static const int MAX_TRACKS = 16;
+        /** The most output ports that can be sent to. */
+        static const int MAX_PORTS = 8;
+        /** Milliseconds of playback rendered ahead by default. */
+        static const int DEFAULT_LOOKAHEAD = 20;
+        
+        /**
+         *  Constructor. Starts with no tracks.
+         *  @param the device for port 0, this takes ownership.
+         */
+        Sequencer(std::unique_ptr<MidiOutput> output);
+        
+        /** Destructor. Stops playback & the prefetch thread. */
+        ~Sequencer();
+        
+        /**
+         *  Adds a track at the current resolution. A track added during
+         *  playback joins at the next step. Message thread only.
+         *  @return the index of the new track.
+         */
+        int addTrack();
+        
+        /** Getter for the number of tracks. Lock free. */
+        int getNumTracks() const { return numTracks.get(); }
+        
+        /**
+         *  Accessor for a track.
+         *  @param the index of the track.
+         *  @return the track.
+         */
+        Track& getTrack(const int index);
+        
+        /** Accessor for a track. */
+        const Track& getTrack(const int index) const;
+        
+        /**
+         *  Adds an output port, tracks & rows can then be routed to it.
+         *  Message thread only.
+         *  @param the device to send to, this takes ownership.
+         *  @return the index of the new port, or -1 if there is no device.
+         */
+        int addPort(std::unique_ptr<MidiOutput> device);
+        
+        /** Getter for the number of output ports. Lock free. */
+        int getNumPorts() const { return numPorts.get(); }
+        
+        /**
+         *  Accessor for an output port.
+         *  @param the index of the port.
+         *  @return the port.
+         */
+        MidiPort& getPort(const int index);
+        
+        /**
+         *  Setter for the tempo. While playing the clock picks it up from the
+         *  end of what it has already rendered, so the musical position
+         *  carries on without a jump & only later events are retimed.
+         *  @param the tempo in quarter notes per minute.
+         */
+        void setTempo(const double beatsPerMinute);
+        
+        /**
+         *  Sets the resolution every track is compiled & played at, only
+         *  while stopped.
+         *  @param the ticks in each quarter note, a multiple of four.
+         */
+        void setPpq(const int ticksPerQuarterNote);
+        
+        /** Accessor for the tempo & resolution. Message thread only. */
+        const MusicalClock& getMusicalClock() const { return musicalClock; }
+        
+        /**
+         *  Sets how far ahead the clock renders events for the output to send.
+         *  A longer window rides out scheduling hiccups but delays live edits.
+         *  @param the lookahead in milliseconds.
+         */
+        void setLookahead(const int milliseconds);
+        
+        /** Getter for the lookahead in milliseconds. */
+        int getLookahead() const { return lookahead.get(); }
+        
+        /** Compiles the start of every track, then starts the clock. */
+        void start();
+        
+        /** Stops the clock, drops anything queued & releases held notes. */
+        void stop();
+        
+        /** Getter for the playback state. */
+        bool isRunning() const { return running.get(); }
+        
+        //======================================================================
+        
+        /**
+         *  Listener for the clock stopping itself.
+         */
+        class Listener
+        {
+        public:
+            /** Virtual destructor. */
+            virtual ~Listener(){}
+            
+            /**
+             *  Alerts when the clock has stopped as no track has anything to
+             *  play. Called on the clock thread, held notes are not released.
+             */
+            virtual void playbackStopped() = 0;
+        };
+        
+        /**
+         *  Setter for the listener, only while stopped.
+         *  @param A pointer to the listener.
+         */
+        void addListener(Listener* listenerParam) { listener = listenerParam; }
+    
+    private:
+        /** A time stamped message waiting to be merged. */
+        struct PendingEvent
+        {
+            /** When the message is due. */
+            std::chrono::steady_clock::time_point time;
+            /** The packed message, on the track's channel. */
+            uint32 message;
+            /** The index of the port it is sent to. */
+            int port;
+        };
+        
+        /** The point the tempo last changed at, owned by the clock. */
+        struct Timebase
+        {
+            /** When originTick is due. */
+            std::chrono::steady_clock::time_point origin;
+            /** The first whole tick timed at the new tempo, in ticks since playback started. */
+            uint64 originTick;
+        };
+        
+        /** Where the clock is in a track, owned by the clock. */
+        struct TrackCursor
+        {
+            /** Ticks from the start of playback to the start of the current loop. */
+            uint64 loopStartTick;
+            /** The first tick of the loop not yet rendered. */
+            uint32 nextTick;
+            /** The chain entry being played. */
+            int chainEntry;
+            /** The number of times the current chain entry has looped. */
+            int repeatCount;
+        };
+        
+        /** Compiles the upcoming patterns of every track when asked. */
+        class Prefetcher : public Thread
+        {
+        public:
+            /**
+             *  Constructor.
+             *  @param the sequencer whose tracks are compiled.
+             */
+            Prefetcher(Sequencer& owner);
+            
+            /** Waits for a request, then prefetches every track. */
+            void run() override;
+        
+        private:
+            /** The sequencer whose tracks are compiled. */
+            Sequencer& sequencer;
+        };
+        
+        /**
+         *  The playback clock. Sleeps on an absolute monotonic deadline until
+         *  the next event of any track comes within the lookahead, then merges
+         *  every track's events in the window into the queues of their ports.
+         */
+        void run() override;
+        
+        /**
+         *  Renders a track's events in the window, in time order, moving it
+         *  along its chain as loops end.
+         *  @param track is the track to be rendered.
+         *  @param cursor is where the clock is in the track.
+         *  @param horizon is the end of the window.
+         *  @param events receives the events.
+         *  @return when the track next needs rendering, or the time_point's
+         *          max if its chain is empty.
+         */
+        std::chrono::steady_clock::time_point renderTrack(Track& track,
+                                                          TrackCursor& cursor,
+                                                          const std::chrono::steady_clock::time_point horizon,
+                                                          Array<PendingEvent>& events);
+        
+        /**
+         *  Converts a musical position to time, at the current tempo. Integer
+         *  arithmetic only, this is called for every event played.
+         *  @param the number of ticks since playback started.
+         *  @return when that tick is due.
+         */
+        std::chrono::steady_clock::time_point timeOf(const uint64 tick) const;
+        
+        /**
+         *  Converts a time to a musical position, at the current tempo.
+         *  @param the time.
+         *  @return the ticks since playback started, with any fraction.
+         */
+        double tickAt(const std::chrono::steady_clock::time_point time) const;
+        
+        /**
+         *  Sleeps the clock until a deadline, or until it is woken.
+         *  @param the absolute time to wake at.
+         */
+        void waitForClock(const std::chrono::steady_clock::time_point deadline);
+        
+        /** Wakes the clock early, e.g. to stop or to reread a schedule. */
+        void wakeClock();
+        
+        /**
+         *  Wakes the clock when a schedule it might be playing is replaced.
+         *  @param the index of the pattern.
+         */
+        void scheduleCompiled(const int pattern) override;
+        
+        /** Wakes the prefetch thread. */
+        void prefetchRequested() override;
+        
+        /** Every output port, only ever added to while playing. */
+        std::unique_ptr<MidiPort> ports[MAX_PORTS];
+        /** The number of ports published to the clock. */
+        Atomic<int> numPorts;
+        /** Every track, only ever added to while playing. */
+        std::unique_ptr<Track> tracks[MAX_TRACKS];
+        /** The number of tracks published to the clock. */
+        Atomic<int> numTracks;
+        /** Compiles upcoming patterns off the clock. */
+        Prefetcher prefetcher;
+        /** Told when the clock stops itself. */
+        Listener* listener;
+        
+        /** The tempo & resolution, set on the message thread. */
+        MusicalClock musicalClock;
+        /** The clock's copy of the time base, taken as playback starts. */
+        MusicalClock playbackClock;
+        /** Where the clock's tempo last changed. */
+        Timebase timebase;
+        /** The tempo set on the message thread, for the clock to pick up. */
+        Atomic<double> tempo;
+        /** How far ahead the clock renders, in milliseconds. */
+        Atomic<int> lookahead;
+        /** The current state of playback. */
+        Atomic<bool> running;
+        
+        /** Guards the clock's wake flag. */
+        std::mutex clockMutex;
+        /** Signalled to wake the clock before its deadline. */
+        std::condition_variable clockCondition;
+        /** Set when the clock has been woken. */
+        bool clockWoken;
+        
+        JUCE_DECLARE_NON_COPYABLE (Sequencer)
+    };
+    
+} //namespace audio
@@ -0,0 +1,180 @@
+/**
+ *  @file    SnapshotPublisher.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Publishes immutable snapshots to reader threads with an atomic pointer
+ *  swap, reclaiming old snapshots once no reader can see them (RCU).
+ *
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  Publishes immutable snapshots with an atomic pointer swap. Readers
+     *  never lock or copy, they pin the current snapshot for the length of a
+     *  ScopedRead. Replaced snapshots are freed by the writer once every
+     *  reader has moved on to a later epoch.
+     *
+     *  There must be a single writer thread, and each reader thread must use
+     *  its own reader index.
+     */
+    template <typename ObjectType>
+    class SnapshotPublisher
+    {
+    public:
+        /** The most reader threads that can pin snapshots at once. */
+        static const int MAX_READERS = 4;
+        
+        /** Constructor. Starts with no snapshot published. */
+        SnapshotPublisher()
+        {
+            current.set(nullptr);
+            globalEpoch.set(1);
+            
+            for(int i = 0; i < MAX_READERS; ++i)
+                readerEpoch[i].set(0); // idle
+        }
+        
+        /** Destructor. No reader may still be inside a ScopedRead! */
+        ~SnapshotPublisher()
+        {
+            delete current.get();
+            
+            for(auto& retired : retiredList)
+                delete retired.object;
+        }
+        
+        /**
+         *  Swaps in a new snapshot. The old one is retired and freed when no
+         *  reader can still be using it. Writer thread only.
+         *  @param the new snapshot, this takes ownership.
+         */
+        void publish(std::unique_ptr<ObjectType> snapshot)
+        {
+            ObjectType* old = current.exchange(snapshot.release());
+            
+            if(old != nullptr)
+                retiredList.add({ old, globalEpoch.get() });
+            
+            // readers entering from here on can only see the new snapshot
+            ++globalEpoch;
+            
+            reclaim();
+        }
+        
+        /**
+         *  Accessor for the latest snapshot, for building the next one from.
+         *  Writer thread only, only the writer ever frees a snapshot.
+         *  @return the snapshot, or nullptr if none has been published.
+         */
+        const ObjectType* getCurrent() const { return current.get(); }
+        
+        /**
+         *  Frees every retired snapshot that no reader can still see.
+         *  Writer thread only.
+         */
+        void reclaim()
+        {
+            // the oldest epoch any reader is currently inside
+            uint64 oldest = globalEpoch.get();
+            for(int i = 0; i < MAX_READERS; ++i)
+            {
+                const uint64 epoch = readerEpoch[i].get();
+                if(epoch != 0)
+                    oldest = jmin(oldest, epoch);
+            }
+            
+            // anything retired before that epoch is unreachable
+            for(int i = retiredList.size(); --i >= 0;)
+            {
+                if(retiredList.getReference(i).epoch < oldest)
+                {
+                    delete retiredList.getReference(i).object;
+                    retiredList.remove(i);
+                }
+            }
+        }
+        
+        //======================================================================
+        
+        /**
+         *  Pins the current snapshot for as long as this object lives.
+         *  Reads are wait free: two atomic stores and a load.
+         */
+        class ScopedRead
+        {
+        public:
+            /**
+             *  Constructor. Enters the current epoch & loads the snapshot.
+             *  @param publisher is the owner of the snapshot.
+             *  @param readerIndex is unique to the reading thread.
+             */
+            ScopedRead(SnapshotPublisher& publisherParam, const int readerIndexParam)
+                : publisher(publisherParam), readerIndex(readerIndexParam)
+            {
+                // each reader thread needs its own slot!!!
+                jassert(readerIndex >= 0 && readerIndex < MAX_READERS);
+                
+                publisher.readerEpoch[readerIndex].set(publisher.globalEpoch.get());
+                snapshot = publisher.current.get();
+            }
+            
+            /** Destructor. Leaves the epoch so the snapshot can be freed. */
+            ~ScopedRead()
+            {
+                publisher.readerEpoch[readerIndex].set(0);
+            }
+            
+            /**
+             *  Accessor for the pinned snapshot.
+             *  @return the snapshot, or nullptr if none has been published.
+             */
+            const ObjectType* get() const { return snapshot; }
+            
+            /** Accessor for the pinned snapshot. */
+            const ObjectType* operator->() const { return snapshot; }
+        
+        private:
+            /** The publisher the snapshot belongs to. */
+            SnapshotPublisher& publisher;
+            /** The slot this reader announces its epoch in. */
+            const int readerIndex;
+            /** The snapshot pinned by this read. */
+            const ObjectType* snapshot;
+            
+            JUCE_DECLARE_NON_COPYABLE (ScopedRead)
+        };
+    
+    private:
+        /** A replaced snapshot waiting to be freed. */
+        struct Retired
+        {
+            /** The replaced snapshot. */
+            ObjectType* object;
+            /** The epoch it was replaced in. */
+            uint64 epoch;
+        };
+        
+        /** The most recently published snapshot. */
+        Atomic<ObjectType*> current;
+        /** Incremented on every publish. */
+        Atomic<uint64> globalEpoch;
+        /** The epoch each reader entered in, or 0 when idle. */
+        Atomic<uint64> readerEpoch[MAX_READERS];
+        /** Snapshots replaced but possibly still being read. */
+        Array<Retired> retiredList;
+        
+        JUCE_DECLARE_NON_COPYABLE (SnapshotPublisher)
+    };
+    
+} //namespace audio
@@ -0,0 +1,448 @@
+/*
+  ==============================================================================
+
+    Song.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "Song.h"
+
+namespace audio
+{
+    Song::Song()
+    {
+        rowCount = 0;
+        columnCount.set(0);
+        ticksPerStep = MusicalClock::DEFAULT_PPQ / MusicalClock::STEPS_PER_BEAT;
+        startNote = 60;
+        velocity = 90;
+        noteMode = MidiEventList::retrigger;
+        swing = 0.0f;
+        for(int row = 0; row < Pattern::MAX_ROWS; ++row)
+        {
+            rowTargets[row] = RowTarget::getDefault(row);
+            rowTimings[row] = { 0, 1 };
+        }
+        playingEntry.set(0);
+        listener = nullptr;
+        updateNoteRows();
+        
+        // a single pattern played on repeat
+        addPattern();
+        setChain({ { 0, 1 } });
+    }
+    
+    Song::~Song(){}
+    
+    //==========================================================================
+    
+    int Song::addPattern()
+    {
+        const ScopedLock sl (lock);
+        
+        // the schedule slots are fixed so the clock can read them unlocked!!!
+        jassert(patterns.size() < MAX_PATTERNS);
+        
+        MidiEventList* pattern = patterns.add(new MidiEventList());
+        pattern->setGridSize(rowCount, columnCount.get());
+        pattern->setStepNotes(startNote, velocity);
+        pattern->setNoteMode(noteMode);
+        pattern->setTicksPerStep(ticksPerStep);
+        pattern->setSwing(swing);
+        for(int row = 0; row < Pattern::MAX_ROWS; ++row)
+        {
+            pattern->setRowTarget(row, rowTargets[row]);
+            pattern->setRowTiming(row, rowTimings[row]);
+        }
+        stale.add(true);
+        
+        return patterns.size() - 1;
+    }
+    
+    int Song::getNumPatterns() const
+    {
+        const ScopedLock sl (lock);
+        return patterns.size();
+    }
+    
+    void Song::setNumPatterns(const int count)
+    {
+        while(getNumPatterns() < count)
+            addPattern();
+        
+        const ScopedLock sl (lock);
+        
+        // the chain still refers to a pattern being removed!!!
+        for(auto& entry : chain)
+            jassert(entry.pattern < jmax(1, count));
+        
+        while(patterns.size() > jmax(1, count))
+        {
+            patterns.removeLast();
+            stale.removeLast();
+        }
+    }
+    
+    void Song::setGridSize(const int rows, const int columns)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            rowCount = rows;
+            columnCount.set(columns);
+            updateNoteRows();
+            
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setGridSize(rows, columns);
+                stale.set(i, true);
+            }
+        }
+        
+        requestPrefetch();
+    }
+    
+    void Song::setStepNotes(const int startNoteParam, const uint8 velocityParam)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            startNote = startNoteParam;
+            velocity = velocityParam;
+            updateNoteRows();
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setStepNotes(startNote, velocity);
+                stale.set(i, true);
+            }
+        }
+        
+        requestPrefetch();
+    }
+    
+    void Song::setNoteMode(const MidiEventList::NoteMode mode)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            if(noteMode == mode)
+                return;
+            
+            noteMode = mode;
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setNoteMode(noteMode);
+                stale.set(i, true);
+            }
+        }
+        
+        requestPrefetch();
+    }
+    
+    MidiEventList::NoteMode Song::getNoteMode() const
+    {
+        const ScopedLock sl (lock);
+        return noteMode;
+    }
+    
+    void Song::setRowTarget(const int row, const RowTarget target)
+    {
+        // the row you are mapping is out of range!!!
+        jassert(row >= 0 && row < Pattern::MAX_ROWS);
+        
+        {
+            const ScopedLock sl (lock);
+            
+            rowTargets[row & (Pattern::MAX_ROWS - 1)] = target;
+            updateNoteRows();
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setRowTarget(row, target);
+                stale.set(i, true);
+            }
+        }
+        
+        requestPrefetch();
+    }
+    
+    void Song::setSwing(const float amount)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            if(swing == amount)
+                return;
+            
+            swing = amount;
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setSwing(swing);
+                stale.set(i, true);
+            }
+        }
+        
+        requestPrefetch();
+    }
+    
+    void Song::setRowTiming(const int row, const RowTiming timing)
+    {
+        // the row you are timing is out of range!!!
+        jassert(row >= 0 && row < Pattern::MAX_ROWS);
+        
+        {
+            const ScopedLock sl (lock);
+            
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setRowTiming(row, timing);
+                stale.set(i, true);
+            }
+            
+            // kept as the patterns clamp it
+            rowTimings[row & (Pattern::MAX_ROWS - 1)] = patterns[0]->getRowTiming(row);
+        }
+        
+        requestPrefetch();
+    }
+    
+    RowTiming Song::getRowTiming(const int row) const
+    {
+        const ScopedLock sl (lock);
+        return rowTimings[row & (Pattern::MAX_ROWS - 1)];
+    }
+    
+    RowTarget Song::getRowTarget(const int row) const
+    {
+        const ScopedLock sl (lock);
+        return rowTargets[row & (Pattern::MAX_ROWS - 1)];
+    }
+    
+    int Song::getRowForNote(const int channel, const int note) const
+    {
+        if(channel > 0)
+            return noteRows[((channel - 1) & 15) * 128 + (note & 127)].get();
+        
+        // any channel, the lowest row wins as it does on a single channel
+        int found = -1;
+        for(int i = 0; i < 16; ++i)
+        {
+            const int row = noteRows[i * 128 + (note & 127)].get();
+            if(row >= 0 && (found < 0 || row < found))
+                found = row;
+        }
+        
+        return found;
+    }
+    
+    uint16 Song::getChannelsUsed() const
+    {
+        const ScopedLock sl (lock);
+        
+        uint16 channels = 0;
+        for(int row = 0; row < rowCount; ++row)
+            channels |= (uint16)(1 << (rowTargets[row].channel - 1));
+        
+        return channels;
+    }
+    
+    void Song::setTicksPerStep(const int ticks)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            ticksPerStep = ticks;
+            for(int i = 0; i < patterns.size(); ++i)
+            {
+                patterns[i]->setTicksPerStep(ticksPerStep);
+                stale.set(i, true);
+            }
+            
+            // row offsets are rescaled with the steps
+            for(int row = 0; row < Pattern::MAX_ROWS; ++row)
+                rowTimings[row] = patterns[0]->getRowTiming(row);
+        }
+        
+        requestPrefetch();
+    }
+    
+    void Song::setStep(const int pattern, const int row, const int column, const bool state)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            MidiEventList& eventList = *patterns[pattern];
+            if(eventList.getStep(row, column) == state)
+                return;
+            
+            eventList.setStep(row, column, state);
+            
+            // an up to date schedule is patched rather than recompiled, a legato or ratcheted step is more than one note
+            const PlaybackSchedule* current = schedules[pattern].getCurrent();
+            if(stale[pattern] == false && current != nullptr
+               && eventList.getNoteMode() == MidiEventList::retrigger
+               && eventList.getRowTiming(row).ratchets == 1
+               && row < eventList.getPattern().getNumRows()
+               && column < eventList.getPattern().getNumSteps())
+            {
+                auto toScheduled = [&eventList, row, column] (const bool isNoteOn)
+                {
+                    const MidiMessage event = eventList.getStepEvent(row, column, isNoteOn);
+                    return ScheduledEvent { (uint32)roundToInt(event.getTimeStamp()),
+                                            PlaybackSchedule::packMessage(event) };
+                };
+                
+                schedules[pattern].publish(std::make_unique<PlaybackSchedule>(*current, toScheduled(true), toScheduled(false), state));
+                
+                // wakes the clock in case the step is due before whatever it was waiting for
+                if(listener != nullptr)
+                    listener->scheduleCompiled(pattern);
+                return;
+            }
+            
+            stale.set(pattern, true);
+        }
+        
+        // only recompiled now if the pattern is playing or up next
+        requestPrefetch();
+    }
+    
+    bool Song::getStep(const int pattern, const int row, const int column) const
+    {
+        const ScopedLock sl (lock);
+        return patterns[pattern]->getStep(row, column);
+    }
+    
+    Pattern Song::getPattern(const int pattern) const
+    {
+        const ScopedLock sl (lock);
+        return patterns[pattern]->getPattern();
+    }
+    
+    void Song::setPatternSteps(const int pattern, const StepMask* source, const int stepCount)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            patterns[pattern]->setSteps(source, stepCount);
+            stale.set(pattern, true);
+        }
+        
+        requestPrefetch();
+    }
+    
+    //==========================================================================
+    
+    void Song::setChain(const Chain& newChain)
+    {
+        {
+            const ScopedLock sl (lock);
+            
+            // the chain refers to a pattern that does not exist!!!
+            for(auto& entry : newChain)
+                jassert(entry.pattern >= 0 && entry.pattern < patterns.size() && entry.repeats > 0);
+            
+            chain = newChain;
+        }
+        
+        chainPublisher.publish(std::make_unique<Chain>(newChain));
+        requestPrefetch();
+    }
+    
+    Song::Chain Song::getChain() const
+    {
+        const ScopedLock sl (lock);
+        return chain;
+    }
+    
+    void Song::prepareToPlay()
+    {
+        playingEntry.set(0);
+        compileAround(0);
+    }
+    
+    void Song::compilePattern(const int pattern)
+    {
+        const ScopedLock sl (lock);
+        compileIfStale(pattern);
+    }
+    
+    //==========================================================================
+    
+    Song::SchedulePublisher& Song::getSchedule(const int pattern)
+    {
+        // the pattern you are playing is out of range!!!
+        jassert(pattern >= 0 && pattern < MAX_PATTERNS);
+        
+        return schedules[pattern];
+    }
+    
+    void Song::setPlayingEntry(const int entry)
+    {
+        playingEntry.set(entry);
+        requestPrefetch();
+    }
+    
+    //==========================================================================
+    
+    void Song::prefetch()
+    {
+        compileAround(playingEntry.get());
+    }
+    
+    void Song::requestPrefetch()
+    {
+        if(listener != nullptr)
+            listener->prefetchRequested();
+    }
+    
+    void Song::updateNoteRows()
+    {
+        // built aside then copied, so a reader never sees the table half empty
+        int rows[16 * 128];
+        for(int& row : rows)
+            row = -1;
+        
+        // the notes are clamped as the patterns clamp them
+        for(int row = jmin(rowCount, (int)Pattern::MAX_ROWS); --row >= 0;)
+        {
+            const RowTarget& target = rowTargets[row];
+            const int channel = jlimit(1, 16, (int)target.channel);
+            const int note = jlimit(0, 127, target.note >= 0 ? (int)target.note : startNote + row);
+            rows[(channel - 1) * 128 + note] = row;
+        }
+        
+        for(int i = 0; i < 16 * 128; ++i)
+            noteRows[i].set(rows[i]);
+    }
+    
+    void Song::compileAround(const int entry)
+    {
+        const ScopedLock sl (lock);
+        
+        if(chain.isEmpty())
+            return;
+        
+        // the playing pattern first, then prefetch the next one
+        compileIfStale(chain.getReference(entry % chain.size()).pattern);
+        compileIfStale(chain.getReference((entry + 1) % chain.size()).pattern);
+    }
+    
+    void Song::compileIfStale(const int pattern)
+    {
+        if(stale[pattern] == false)
+            return; // the cached schedule is still current
+        
+        const MidiEventList& eventList = *patterns[pattern];
+        schedules[pattern].publish(std::make_unique<PlaybackSchedule>(eventList,
+                                                                      eventList.getPattern().getNumSteps(),
+                                                                      ticksPerStep));
+        stale.set(pattern, false);
+        
+        if(listener != nullptr)
+            listener->scheduleCompiled(pattern);
+    }
+    
+} //namespace audio
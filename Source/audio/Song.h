@@ -0,0 +1,343 @@
+/**
+ *  @file    Song.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  A song arrangement, a chain of patterns each repeated a number of times.
+ *
+ */
+
+#pragma once
+
+#include "MidiEventList.h"
+#include "MusicalClock.h"
+#include "PlaybackSchedule.h"
+#include "SnapshotPublisher.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  A single link in the song chain.
+     */
+    struct ChainEntry
+    {
+        /** The index of the pattern to be played. */
+        int pattern;
+        /** The number of times the pattern loops before moving on. */
+        int repeats;
+    };
+    
+    //==========================================================================
+    
+    /**
+     *  A song arrangement, a chain of patterns each repeated a number of
+     *  times. Each pattern's schedule is compiled lazily and cached until the
+     *  pattern is next edited. Whatever plays the song compiles the playing
+     *  pattern and the one after it on a background thread when asked, so the
+     *  clock only ever reads published schedules and never waits on a compile.
+     */
+    class Song
+    {
+    public:
+        /** Publisher type for compiled schedules. */
+        typedef SnapshotPublisher<PlaybackSchedule> SchedulePublisher;
+        /** The order patterns are played in. */
+        typedef Array<ChainEntry> Chain;
+        /** Publisher type for the chain. */
+        typedef SnapshotPublisher<Chain> ChainPublisher;
+        
+        /** The most patterns a song can hold. */
+        static const int MAX_PATTERNS = 256;
+        /** The reader slot used by the playback clock. */
+        static const int PLAYBACK_READER = 0;
+        /** The reader slot used by the message thread, e.g. for exporting. */
+        static const int MESSAGE_READER = 1;
+        
+        /** Constructor. Starts with a single pattern played on repeat. */
+        Song();
+        
+        /** Destructor. */
+        ~Song();
+        
+        /**
+         *  Adds an empty pattern sized to the current grid.
+         *  @return the index of the new pattern.
+         */
+        int addPattern();
+        
+        /** Getter for the number of patterns. */
+        int getNumPatterns() const;
+        
+        /** Getter for the number of columns in every pattern. Lock free. */
+        int getNumColumns() const { return columnCount.get(); }
+        
+        /**
+         *  Adds or removes patterns from the end of the song, at least one is
+         *  always kept. The chain must not refer to any pattern removed.
+         *  @param the number of patterns wanted.
+         */
+        void setNumPatterns(const int count);
+        
+        /**
+         *  Resizes the step grid of every pattern, clearing all steps.
+         *  @param rows is the number of rows (notes) in the grid.
+         *  @param columns is the number of steps in each row.
+         */
+        void setGridSize(const int rows, const int columns);
+        
+        /**
+         *  Sets the notes built for the steps of every pattern.
+         *  @param startNote is the note number of the bottom row.
+         *  @param velocity is the velocity of every step.
+         */
+        void setStepNotes(const int startNote, const uint8 velocity);
+        
+        /**
+         *  Sets how the steps of every pattern are turned into notes.
+         *  @param the note mode.
+         */
+        void setNoteMode(const MidiEventList::NoteMode mode);
+        
+        /** Getter for how the steps of every pattern are turned into notes. */
+        MidiEventList::NoteMode getNoteMode() const;
+        
+        /**
+         *  Maps a row of every pattern onto a midi channel & note.
+         *  @param row is the row index.
+         *  @param target is the channel & note the row's steps are sent to.
+         */
+        void setRowTarget(const int row, const RowTarget target);
+        
+        /**
+         *  Sets the swing of every pattern.
+         *  @param the fraction of a step the off beats are delayed, 0 to 0.75.
+         */
+        void setSwing(const float amount);
+        
+        /**
+         *  Nudges a row of every pattern off the grid or ratchets its steps.
+         *  @param row is the row index.
+         *  @param timing is the offset in ticks & ratchets of the row.
+         */
+        void setRowTiming(const int row, const RowTiming timing);
+        
+        /**
+         *  Getter for the timing of a row.
+         *  @param the row index.
+         *  @return the offset & ratchets of the row.
+         */
+        RowTiming getRowTiming(const int row) const;
+        
+        /**
+         *  Getter for where a row's notes are sent.
+         *  @param the row index.
+         *  @return the channel & note of the row.
+         */
+        RowTarget getRowTarget(const int row) const;
+        
+        /**
+         *  Finds the row of the grid that plays a note. Lock free, so the
+         *  synth can pick the row's sample & bus as each note on arrives.
+         *  @param channel is the midi channel, 1 to 16, or 0 for any channel.
+         *  @param note is the note number.
+         *  @return the lowest row playing the note, or -1 if none does.
+         */
+        int getRowForNote(const int channel, const int note) const;
+        
+        /**
+         *  Finds every channel the rows of the grid are mapped onto.
+         *  @return a bit for each channel, channel 1 in the lowest bit.
+         */
+        uint16 getChannelsUsed() const;
+        
+        /**
+         *  Sets the resolution every pattern is compiled at.
+         *  @param the ticks in each sequencer step.
+         */
+        void setTicksPerStep(const int ticks);
+        
+        /**
+         *  Turns a step of a pattern on or off. An up to date schedule has
+         *  just that step patched in & republished, so an edit ahead of the
+         *  playhead is heard on the same loop. Otherwise the pattern is
+         *  recompiled straight away if it is playing or up next, or when needed.
+         *  @param pattern is the index of the pattern.
+         *  @param row is the row index of the step.
+         *  @param column is the column index of the step.
+         *  @param state is true for an active step.
+         */
+        void setStep(const int pattern, const int row, const int column, const bool state);
+        
+        /**
+         *  Returns the state of a step of a pattern.
+         *  @param pattern is the index of the pattern.
+         *  @param row is the row index of the step.
+         *  @param column is the column index of the step.
+         *  @return true if the step is active.
+         */
+        bool getStep(const int pattern, const int row, const int column) const;
+        
+        /**
+         *  Returns a copy of every step in a pattern, for saving.
+         *  @param the index of the pattern.
+         *  @return the steps of that pattern.
+         */
+        Pattern getPattern(const int pattern) const;
+        
+        /**
+         *  Copies every step of a pattern in as a block, for loading.
+         *  @param pattern is the index of the pattern.
+         *  @param source is the first of the step masks to be copied.
+         *  @param stepCount is the number of step masks at source.
+         */
+        void setPatternSteps(const int pattern, const StepMask* source, const int stepCount);
+        
+        /**
+         *  Sets the order patterns are played in.
+         *  @param the new chain, every entry must refer to an existing pattern.
+         */
+        void setChain(const Chain& newChain);
+        
+        /** Getter for a copy of the chain. */
+        Chain getChain() const;
+        
+        /**
+         *  Compiles the first two entries of the chain, if needed, so playback
+         *  can start without waiting. Message thread only.
+         */
+        void prepareToPlay();
+        
+        /**
+         *  Compiles a pattern straight away if it is stale, e.g. before
+         *  reading its schedule for exporting. Message thread only.
+         *  @param the index of the pattern.
+         */
+        void compilePattern(const int pattern);
+        
+        //======================================================================
+        
+        /**
+         *  Accessor for the chain, for playback. Read with PLAYBACK_READER.
+         *  @return the publisher of the chain.
+         */
+        ChainPublisher& getChainPublisher() { return chainPublisher; }
+        
+        /**
+         *  Accessor for a pattern's compiled schedule, for playback. Read with
+         *  PLAYBACK_READER, the schedule is null if it was never compiled.
+         *  @param the index of the pattern.
+         *  @return the publisher of that pattern's schedule.
+         */
+        SchedulePublisher& getSchedule(const int pattern);
+        
+        /**
+         *  Tells the song which chain entry is playing, the one after it is
+         *  then prefetched. Lock free, safe to call from the clock.
+         *  @param the index of the chain entry now playing.
+         */
+        void setPlayingEntry(const int entry);
+        
+        /**
+         *  Compiles the playing chain entry and the one after it, if they are
+         *  stale. Called from a background thread when the listener is asked.
+         */
+        void prefetch();
+        
+        /**
+         *  Listener for newly compiled schedules.
+         */
+        class Listener
+        {
+        public:
+            /** Virtual destructor. */
+            virtual ~Listener(){}
+            
+            /**
+             *  Alerts when a pattern's schedule has been published. Called from
+             *  whichever thread compiled it, with the song's lock held.
+             *  @param the index of the pattern.
+             */
+            virtual void scheduleCompiled(const int pattern) = 0;
+            
+            /**
+             *  Alerts when a pattern may need compiling, prefetch should then
+             *  be called from a background thread. Lock free.
+             */
+            virtual void prefetchRequested() = 0;
+        };
+        
+        /**
+         *  Setter for the schedule listener.
+         *  @param A pointer to the listener.
+         */
+        void addListener(Listener* listenerParam) { listener = listenerParam; }
+    
+    private:
+        /** Asks the listener for a prefetch. */
+        void requestPrefetch();
+        
+        /** Rebuilds the row each channel & note plays, the lock must be held. */
+        void updateNoteRows();
+        
+        /**
+         *  Compiles a chain entry and the one after it, if they are stale.
+         *  @param the index of the chain entry.
+         */
+        void compileAround(const int entry);
+        
+        /**
+         *  Compiles a pattern if it has changed since it was last compiled.
+         *  The lock must be held.
+         *  @param the index of the pattern.
+         */
+        void compileIfStale(const int pattern);
+        
+        /** Guards the patterns and stale flags, never taken by the clock. */
+        CriticalSection lock;
+        /** Every pattern, edited on the message thread. */
+        OwnedArray<MidiEventList> patterns;
+        /** Set when a pattern has changed since it was last compiled. */
+        Array<bool> stale;
+        /** The compiled schedule for each pattern slot. */
+        SchedulePublisher schedules[MAX_PATTERNS];
+        
+        /** The message thread's copy of the chain. */
+        Chain chain;
+        /** Hands the chain to playback. */
+        ChainPublisher chainPublisher;
+        
+        /** The chain entry currently playing. */
+        Atomic<int> playingEntry;
+        /** Pointer to the schedule listener. */
+        Listener* listener;
+        /** The number of rows in every pattern. */
+        int rowCount;
+        /** The number of columns in every pattern. */
+        Atomic<int> columnCount;
+        /** The ticks in each step of a compiled schedule. */
+        int ticksPerStep;
+        /** The note number of the bottom row of every pattern. */
+        int startNote;
+        /** The velocity of every step. */
+        uint8 velocity;
+        /** How the steps of every pattern are turned into notes. */
+        MidiEventList::NoteMode noteMode;
+        /** The channel & note of each row, applied to every pattern. */
+        RowTarget rowTargets[Pattern::MAX_ROWS];
+        /** The row of each channel (16 notes apart) & note, or -1, read lock free. */
+        Atomic<int> noteRows[16 * 128];
+        /** The swing of every pattern. */
+        float swing;
+        /** The offset & ratchets of each row, applied to every pattern. */
+        RowTiming rowTimings[Pattern::MAX_ROWS];
+        
+        JUCE_DECLARE_NON_COPYABLE (Song)
+    };
+    
+} //namespace audio
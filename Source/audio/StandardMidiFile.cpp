@@ -0,0 +1,253 @@
+/*
+  ==============================================================================
+
+    StandardMidiFile.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "StandardMidiFile.h"
+
+namespace audio
+{
+    bool StandardMidiFile::write(const File& file,
+                                 const PlaybackSchedule& schedule,
+                                 const int microsecondsPerBeat,
+                                 const int velocity)
+    {
+        // written beside the target, then renamed over it once complete
+        TemporaryFile temporary (file);
+        
+        {
+            FileOutputStream out (temporary.getFile());
+            if(out.failedToOpen())
+                return false;
+            
+            // header, a single track at the resolution the schedule was compiled at
+            bool ok = out.write("MThd", 4);
+            ok = ok && out.writeIntBigEndian(6);
+            ok = ok && out.writeShortBigEndian(0);
+            ok = ok && out.writeShortBigEndian(1);
+            ok = ok && out.writeShortBigEndian((short)(schedule.getTicksPerStep() * MusicalClock::STEPS_PER_BEAT));
+            
+            // the track length is filled in once the events are written
+            ok = ok && out.write("MTrk", 4);
+            const int64 lengthPosition = out.getPosition();
+            ok = ok && out.writeIntBigEndian(0);
+            
+            // tempo
+            const int tempo = jlimit(1, 0xffffff, microsecondsPerBeat);
+            ok = ok && writeVariableLength(out, 0);
+            ok = ok && out.writeByte((char)0xff) && out.writeByte(0x51) && out.writeByte(3);
+            ok = ok && out.writeByte((char)(tempo >> 16)) && out.writeByte((char)(tempo >> 8)) && out.writeByte((char)tempo);
+            
+            // each event streamed straight out of the schedule, repeated status bytes left out
+            MidiWireEncoder encoder (false);
+            uint32 lastTick = 0;
+            for(int i = 0; ok && i < schedule.getNumEvents(); ++i)
+            {
+                const ScheduledEvent& event = schedule.getEvent(i);
+                uint32 message = event.message;
+                if((event.getStatus() & 0xf0) == 0x90 && event.getData2() != 0)
+                    message = (message & ~(uint32)0xff0000) | ((uint32)jlimit(1, 127, velocity) << 16);
+                
+                uint8 bytes[3];
+                const int size = encoder.encode(message, bytes);
+                
+                ok = writeVariableLength(out, event.tick - lastTick);
+                ok = ok && out.write(bytes, (size_t)size);
+                lastTick = event.tick;
+            }
+            
+            // end of track at the end of the loop
+            ok = ok && writeVariableLength(out, jmax(lastTick, schedule.getLengthInTicks()) - lastTick);
+            ok = ok && out.writeByte((char)0xff) && out.writeByte(0x2f) && out.writeByte(0);
+            
+            const int64 endPosition = out.getPosition();
+            ok = ok && out.setPosition(lengthPosition);
+            ok = ok && out.writeIntBigEndian((int)(endPosition - lengthPosition - 4));
+            
+            out.flush();
+            if(ok == false || out.getStatus().failed())
+                return false;
+        }
+        
+        return temporary.overwriteTargetFileWithTemporary();
+    }
+    
+    bool StandardMidiFile::writeVariableLength(OutputStream& out, uint32 value)
+    {
+        // seven bits per byte, most significant first, the top bit set on all but the last
+        uint8 bytes[4];
+        int count = 0;
+        
+        do
+        {
+            bytes[count++] = (uint8)(value & 0x7f);
+            value >>= 7;
+        }
+        while(value != 0 && count < 4);
+        
+        bool ok = true;
+        while(ok && --count >= 0)
+            ok = out.writeByte((char)(bytes[count] | (count > 0 ? 0x80 : 0)));
+        
+        return ok;
+    }
+    
+    //==========================================================================
+    
+    bool StandardMidiFile::read(const File& file,
+                                Pattern& pattern,
+                                const int startNote,
+                                const RowMapping mapping)
+    {
+        FileInputStream fileStream (file);
+        if(fileStream.openedOk() == false)
+            return false;
+        
+        // only a small window of the file is ever held in memory
+        BufferedInputStream in (fileStream, 65536);
+        
+        char chunk[4];
+        if(in.read(chunk, 4) != 4 || memcmp(chunk, "MThd", 4) != 0)
+            return false;
+        
+        const int headerLength = in.readIntBigEndian();
+        in.readShortBigEndian(); // format, every track is read the same way
+        const int numTracks = (uint16)in.readShortBigEndian();
+        const int division = (uint16)in.readShortBigEndian();
+        in.skipNextBytes(headerLength - 6);
+        
+        // smpte time can't be placed onto steps
+        if(division == 0 || (division & 0x8000) != 0)
+            return false;
+        
+        int trackRow = 0;
+        
+        // the header only counts MTrk chunks, any other chunk between them is skipped
+        for(int track = 0; track < numTracks;)
+        {
+            if(in.read(chunk, 4) != 4)
+                return false; // truncated
+            
+            int64 remaining = (uint32)in.readIntBigEndian();
+            
+            if(memcmp(chunk, "MTrk", 4) != 0)
+            {
+                in.skipNextBytes(remaining); // unknown chunks are skipped
+                continue;
+            }
+            
+            ++track;
+            
+            // reads within the track, anything past its end reads as zero
+            auto readByte = [&in, &remaining] () -> uint8
+            {
+                if(remaining <= 0)
+                    return 0;
+                
+                --remaining;
+                return (uint8)in.readByte();
+            };
+            
+            // skips the data of a meta event or sysex, false if the track or file ends first
+            auto skipData = [&in, &remaining] (const int64 length) -> bool
+            {
+                if(length > remaining)
+                    return false;
+                
+                const int64 end = in.getPosition() + length;
+                in.skipNextBytes(length);
+                remaining -= length;
+                return in.isExhausted() == false || in.getPosition() == end;
+            };
+            
+            auto readVariableLength = [&readByte] () -> uint32
+            {
+                uint32 value = 0;
+                for(int i = 0; i < 4; ++i)
+                {
+                    const uint8 byte = readByte();
+                    value = (value << 7) | (byte & 0x7f);
+                    if((byte & 0x80) == 0)
+                        break;
+                }
+                return value;
+            };
+            
+            uint32 tick = 0;
+            uint8 runningStatus = 0;
+            bool trackHasNotes = false;
+            
+            while(remaining > 0 && in.isExhausted() == false)
+            {
+                tick += readVariableLength();
+                
+                uint8 status = readByte();
+                uint8 data1 = 0;
+                
+                if(status < 0x80)
+                {
+                    // running status, this byte is already the first data byte
+                    data1 = status;
+                    status = runningStatus;
+                }
+                else if(status == 0xff)
+                {
+                    readByte(); // meta type
+                    if(skipData(readVariableLength()) == false)
+                        return false; // truncated
+                    continue;
+                }
+                else if(status == 0xf0 || status == 0xf7)
+                {
+                    if(skipData(readVariableLength()) == false)
+                        return false; // truncated
+                    runningStatus = 0;
+                    continue;
+                }
+                else
+                {
+                    runningStatus = status;
+                    data1 = readByte();
+                }
+                
+                if(status < 0x80)
+                    continue; // data without any status to run on
+                
+                // program change & channel pressure have a single data byte
+                const uint8 type = status & 0xf0;
+                const uint8 data2 = (type == 0xc0 || type == 0xd0) ? 0 : readByte();
+                
+                if(type != 0x90 || data2 == 0)
+                    continue; // only note ons place steps
+                
+                int row = data1 - startNote;
+                if(mapping == trackToRow)
+                    row = trackRow;
+                else if(mapping == channelToRow)
+                    row = status & 0x0f;
+                
+                // quantise to the nearest step, division is ticks per quarter note
+                const int step = (int)(((uint64)tick * MusicalClock::STEPS_PER_BEAT + (uint32)division / 2) / (uint32)division);
+                
+                if(row >= 0 && row < pattern.getNumRows() && step < pattern.getNumSteps())
+                    pattern.setStep(row, step, true);
+                
+                trackHasNotes = true;
+            }
+            
+            if(remaining > 0)
+                return false; // truncated
+            
+            if(trackHasNotes)
+                ++trackRow;
+        }
+        
+        return true;
+    }
+    
+} //namespace audio
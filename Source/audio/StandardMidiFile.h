@@ -0,0 +1,83 @@
+/**
+ *  @file    StandardMidiFile.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  Streaming import & export of patterns as Standard MIDI Files.
+ *
+ */
+
+#pragma once
+
+#include "Pattern.h"
+#include "PlaybackSchedule.h"
+#include "MusicalClock.h"
+#include "MidiWire.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  Streaming import & export of patterns as Standard MIDI Files. Neither
+     *  direction holds the whole file in memory, export writes each event as
+     *  it is read from the schedule and import reads one event at a time.
+     *  One sequencer step is one sixteenth note.
+     */
+    class StandardMidiFile
+    {
+    public:
+        /** How imported notes are placed onto rows. */
+        enum RowMapping
+        {
+            noteToRow = 0,  ///< row = note number - start note
+            trackToRow,     ///< each track holding notes is the next row
+            channelToRow    ///< row = midi channel - 1
+        };
+        
+        /**
+         *  Streams a compiled schedule to disk as a format 0 file, through a
+         *  temporary file so an existing file is only replaced once complete.
+         *  @param file is the midi file to be written.
+         *  @param schedule is the compiled pattern.
+         *  @param microsecondsPerBeat is the length of each quarter note.
+         *  @param velocity is written on every note on, as the sequencer sends it.
+         *  @return true if the file was written.
+         */
+        static bool write(const File& file,
+                          const PlaybackSchedule& schedule,
+                          const int microsecondsPerBeat,
+                          const int velocity);
+        
+        /**
+         *  Reads a midi file event by event, turning on the step under each
+         *  note on. Notes outside the pattern are dropped.
+         *  @param file is the midi file to be read.
+         *  @param pattern receives the steps, it is not cleared first.
+         *  @param startNote is the note number of the bottom row.
+         *  @param mapping is how notes are placed onto rows.
+         *  @return true if the whole file was read.
+         */
+        static bool read(const File& file,
+                         Pattern& pattern,
+                         const int startNote,
+                         const RowMapping mapping = noteToRow);
+    
+    private:
+        /** Private constructor. Static functions only! */
+        StandardMidiFile();
+        
+        /**
+         *  Writes a variable length quantity.
+         *  @param out is the stream to be written to.
+         *  @param value is the quantity, up to 28 bits.
+         *  @return true if the bytes were written.
+         */
+        static bool writeVariableLength(OutputStream& out, uint32 value);
+    };
+    
+} //namespace audio
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    Track.cpp
+    Created: 18 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#include "Track.h"
+
+namespace audio
+{
+    Track::Track()
+    {
+        midiChannel.set(0);
+        noteVelocity.set(90);
+        midiPort.set(0);
+        
+        for(auto& notePort : notePorts)
+            notePort.set(-1);
+    }
+    
+    Track::~Track(){}
+    
+    //==========================================================================
+    
+    void Track::setChannel(const int channel)
+    {
+        // midi channels are 1 to 16, or 0 for the rows' own!!!
+        jassert(channel >= 0 && channel <= 16);
+        
+        midiChannel.set(jlimit(0, 16, channel));
+    }
+    
+    void Track::setVelocity(const int velocity)
+    {
+        // a note on of velocity 0 is a note off!!!
+        jassert(velocity >= 1 && velocity <= 127);
+        
+        noteVelocity.set(jlimit(1, 127, velocity));
+    }
+    
+    void Track::setPort(const int port)
+    {
+        // ports are indexed from 0!!!
+        jassert(port >= 0);
+        
+        midiPort.set(jmax(0, port));
+    }
+    
+    void Track::setNotePort(const int channel, const int note, const int port)
+    {
+        // the channel or note you are routing is out of range!!!
+        jassert(channel >= 1 && channel <= 16 && note >= 0 && note < 128);
+        
+        notePorts[((channel - 1) & 15) * 128 + (note & 127)].set(jmax(-1, port));
+    }
+    
+    int Track::getPortForNote(const int channel, const int note) const
+    {
+        const int port = notePorts[((channel - 1) & 15) * 128 + (note & 127)].get();
+        return port >= 0 ? port : midiPort.get();
+    }
+    
+    int Track::getRowForNote(const int channel, const int note) const
+    {
+        // a track moving every row onto its own channel leaves only the note to go on
+        const int trackChannel = midiChannel.get();
+        if(trackChannel > 0)
+            return channel == trackChannel ? song.getRowForNote(0, note) : -1;
+        
+        return song.getRowForNote(channel, note);
+    }
+    
+} //namespace audio
@@ -0,0 +1,113 @@
+/**
+ *  @file    Track.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  A single sequencer track, its own song sent to its own destination.
+ *
+ */
+
+#pragma once
+
+#include "Song.h"
+#include "../JuceLibraryCode/JuceHeader.h"
+
+//==============================================================================
+
+namespace audio
+{
+    /**
+     *  A single sequencer track. Each track has its own patterns, chain &
+     *  length, and sends to its own midi channel & output port. Rows are
+     *  routed to other ports by the channel & note they are mapped onto, so
+     *  rows sharing a note on different channels can go to different ports.
+     *  Tracks are played by a shared @see Sequencer.
+     */
+    class Track
+    {
+    public:
+        /** Constructor. Sends on channel 1 of port 0. */
+        Track();
+        
+        /** Destructor. */
+        ~Track();
+        
+        /** Accessor for the patterns & chain of this track. */
+        Song& getSong() { return song; }
+        
+        /** Accessor for the patterns & chain of this track. */
+        const Song& getSong() const { return song; }
+        
+        /**
+         *  Setter for the destination, takes effect from the next event sent.
+         *  @param the midi channel every event is moved onto, 1 to 16, or 0
+         *         to send each row on the channel it is mapped to.
+         */
+        void setChannel(const int channel);
+        
+        /** Getter for the midi channel. Lock free. */
+        int getChannel() const { return midiChannel.get(); }
+        
+        /**
+         *  Setter for the velocity of every note on, applied as each event is
+         *  rendered so nothing is recompiled. Takes effect from the next note.
+         *  @param the velocity, 1 to 127.
+         */
+        void setVelocity(const int velocity);
+        
+        /** Getter for the velocity of every note on. Lock free. */
+        int getVelocity() const { return noteVelocity.get(); }
+        
+        /**
+         *  Setter for the output port every note is sent to, unless routed.
+         *  @param the index of the port in the sequencer.
+         */
+        void setPort(const int port);
+        
+        /** Getter for the track's output port. Lock free. */
+        int getPort() const { return midiPort.get(); }
+        
+        /**
+         *  Routes the rows mapped onto a channel & note to their own output port.
+         *  @param channel is the midi channel of the row target, 1 to 16.
+         *  @param note is the midi note number of the row target.
+         *  @param port is the index of the port, or -1 for the track's port.
+         */
+        void setNotePort(const int channel, const int note, const int port);
+        
+        /**
+         *  Finds where a note is sent. Lock free.
+         *  @param channel is the midi channel of the row target, before the
+         *         track moves it onto its own.
+         *  @param note is the midi note number.
+         *  @return the index of the port.
+         */
+        int getPortForNote(const int channel, const int note) const;
+        
+        /**
+         *  Finds the row a note sent by this track was played by. Lock free.
+         *  @param channel is the midi channel the note was sent on.
+         *  @param note is the note number.
+         *  @return the row, or -1 if no row of the track sends the note.
+         */
+        int getRowForNote(const int channel, const int note) const;
+    
+    private:
+        /** The patterns & chain. */
+        Song song;
+        /** The midi channel every event is sent on, or 0 for the rows' own. */
+        Atomic<int> midiChannel;
+        /** The velocity every note on is sent at. */
+        Atomic<int> noteVelocity;
+        /** The port every event is sent to unless routed. */
+        Atomic<int> midiPort;
+        /** The port each channel (128 notes apart) & note is routed to, or -1 for the track's port. */
+        Atomic<int> notePorts[16 * 128];
+        
+        JUCE_DECLARE_NON_COPYABLE (Track)
+    };
+    
+} //namespace audio
@@ -20,6 +20,9 @@ namespace gui
         
         addAndMakeVisible(sequencer);
         addAndMakeVisible(controller);
+        
+        // for undo & redo shortcuts
+        setWantsKeyboardFocus(true);
     }
     
     MainComponent::~MainComponent(){}
@@ -45,4 +48,66 @@ namespace gui
         controller.setBounds(controllerRectangle);
     }
     
+    //==========================================================================
+    
+    bool MainComponent::keyPressed (const KeyPress& key)
+    {
+        audio::MidiOut& midiOut = audio::MidiOut::getInstance();
+        
+        if(key == KeyPress('z', ModifierKeys::commandModifier | ModifierKeys::shiftModifier, 0)
+           || key == KeyPress('y', ModifierKeys::commandModifier, 0))
+        {
+            midiOut.redo();
+            return true;
+        }
+        
+        if(key == KeyPress('z', ModifierKeys::commandModifier, 0))
+        {
+            midiOut.undo();
+            return true;
+        }
+        
+        // bulk edits, each one recompile & one repaint
+        if(key == KeyPress(KeyPress::backspaceKey, ModifierKeys::commandModifier, 0))
+            midiOut.clearPattern();
+        else if(key == KeyPress('i', ModifierKeys::commandModifier, 0))
+            midiOut.invertPattern();
+        else if(key == KeyPress(KeyPress::leftKey, ModifierKeys::commandModifier, 0))
+            midiOut.rotatePattern(-1);
+        else if(key == KeyPress(KeyPress::rightKey, ModifierKeys::commandModifier, 0))
+            midiOut.rotatePattern(1);
+        else if(key == KeyPress(KeyPress::upKey, ModifierKeys::commandModifier, 0))
+            midiOut.shiftPatternRows(1);
+        else if(key == KeyPress(KeyPress::downKey, ModifierKeys::commandModifier, 0))
+            midiOut.shiftPatternRows(-1);
+        else if(key == KeyPress('d', ModifierKeys::commandModifier, 0))
+            showDinSkew();
+        else
+            return false;
+        
+        return true;
+    }
+    
+    void MainComponent::showDinSkew()
+    {
+        audio::MidiOut& midiOut = audio::MidiOut::getInstance();
+        const Array<audio::TickSkew> full = midiOut.simulateDinLink(false);
+        const Array<audio::TickSkew> compact = midiOut.simulateDinLink(true);
+        
+        // both runs hold the same ticks, only the bytes sent differ
+        String report = "tick\tmessages\tbytes\tskew (us)\n";
+        for(int i = 0; i < full.size(); ++i)
+        {
+            const audio::TickSkew& tick = full.getReference(i);
+            report << (int)tick.tick << "\t" << tick.numMessages << "\t"
+                   << tick.numBytes << " / " << compact.getReference(i).numBytes << "\t"
+                   << roundToInt(tick.skewMicroseconds) << " / " << roundToInt(compact.getReference(i).skewMicroseconds) << "\n";
+        }
+        
+        report << "\nworst: " << roundToInt(audio::MidiByteBudget::getWorstSkew(full)) << " us, "
+               << roundToInt(audio::MidiByteBudget::getWorstSkew(compact)) << " us compact";
+        
+        AlertWindow::showMessageBoxAsync(AlertWindow::InfoIcon, "DIN link skew (full / compact)", report);
+    }
+    
 } //namespace gui
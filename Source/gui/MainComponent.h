@@ -46,8 +46,24 @@ namespace gui
         /** Sets bounds for sub components. */
         void resized() override;
         
+        /**
+         *  Handles undo (cmd + z) & redo (cmd + shift + z or cmd + y), and
+         *  the bulk edits: clear (cmd + backspace), invert (cmd + i), rotate
+         *  (cmd + left / right) & shift rows (cmd + up / down). Cmd + d
+         *  shows how late each tick of the pattern lands on a DIN link.
+         *  @param the key that was pressed.
+         *  @return true if the key was used.
+         */
+        bool keyPressed (const KeyPress& key) override;
+    
     private:
         
+        /**
+         *  Simulates the pattern being edited on a DIN midi link, with & without
+         *  the compact encoding, and shows the skew of each tick.
+         */
+        void showDinSkew();
+        
         /** Our audio device. */
         audio::Audio& audio;
         
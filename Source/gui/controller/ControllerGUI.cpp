@@ -16,7 +16,7 @@ namespace gui
 {
     ControllerGUI::ControllerGUI(audio::Audio& audioParam) : audio(audioParam)
     {
-        playback = std::make_unique<PlayBackControls>();
+        playback = std::make_unique<PlayBackControls>(audio);
         synthGUI = std::make_unique<SynthesiserGUI>(audio);
         
         addAndMakeVisible(playback.get());
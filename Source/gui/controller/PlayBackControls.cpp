@@ -14,7 +14,7 @@
 
 namespace gui
 {
-    PlayBackControls::PlayBackControls()
+    PlayBackControls::PlayBackControls(audio::Audio& audioParam) : audio(audioParam)
     {
         
         // setup play button
@@ -28,22 +28,64 @@ namespace gui
             {
                 play.setComponentID("stop");
                 play.setButtonText("play");
-                tempo.setVisible(true);
-                velocity.setVisible(true);
+                save.setVisible(true);
+                load.setVisible(true);
                 
             }
             else // if componentID == "stop"    ///< components playing
             {
+                // tempo & velocity stay live, only the project can't change under the clock
                 play.setComponentID("play");
                 play.setButtonText("stop");
-                tempo.setVisible(false);
-                velocity.setVisible(false);
+                save.setVisible(false);
+                load.setVisible(false);
             }
             repaint();
         };
         
         //======================================================================
         
+        // setup project saving & loading
+        addAndMakeVisible(save);
+        save.setButtonText("save");
+        save.onClick = [this]
+        {
+            projectChooser = std::make_unique<FileChooser>("Save project", File(), "*.ssqp;*.mid");
+            projectChooser->launchAsync(FileBrowserComponent::saveMode
+                                        | FileBrowserComponent::warnAboutOverwriting,
+                                        [this] (const FileChooser& chooser)
+            {
+                const File result = chooser.getResult();
+                
+                // a midi file exports the pattern, anything else is a project
+                if(result.hasFileExtension("mid;midi"))
+                    exportMidiFile(result);
+                else if(result != File())
+                    saveProject(result.withFileExtension("ssqp"));
+            });
+        };
+        
+        addAndMakeVisible(load);
+        load.setButtonText("load");
+        load.onClick = [this]
+        {
+            projectChooser = std::make_unique<FileChooser>("Load project", File(), "*.ssqp;*.mid;*.midi");
+            projectChooser->launchAsync(FileBrowserComponent::openMode
+                                        | FileBrowserComponent::canSelectFiles,
+                                        [this] (const FileChooser& chooser)
+            {
+                const File result = chooser.getResult();
+                
+                // a midi file imports into the pattern, anything else is a project
+                if(result.existsAsFile() && result.hasFileExtension("mid;midi"))
+                    importMidiFile(result);
+                else if(result.existsAsFile())
+                    loadProject(result);
+            });
+        };
+        
+        //======================================================================
+        
         // setup tempo control
         addAndMakeVisible(tempo);
         tempo.setComponentID("tempo");
@@ -55,7 +97,7 @@ namespace gui
         tempo.setValue(120.0);
         tempo.onValueChange = [this]
         {
-            audio::MidiOut::getInstance().setPlayback("tempo", tempo.getValue());
+            audio::MidiOut::getInstance().setPlayback(audio::PlaybackSettings::tempo, (float)tempo.getValue());
         };
         
         //======================================================================
@@ -71,7 +113,27 @@ namespace gui
         velocity.setValue(98.0);
         velocity.onValueChange = [this]
         {
-            audio::MidiOut::getInstance().setPlayback("velocity", velocity.getValue());
+            audio::MidiOut::getInstance().setPlayback(audio::PlaybackSettings::velocity, (float)velocity.getValue());
+        };
+        
+        //======================================================================
+        
+        // setup note mode toggle, runs of steps play as one note while on
+        addAndMakeVisible(legato);
+        legato.setComponentID("legato");
+        legato.setButtonText("legato");
+        legato.onClick = [this]
+        {
+            audio::MidiOut::getInstance().setPlayback(audio::PlaybackSettings::noteMode, legato.getToggleState() ? 1.0f : 0.0f);
+        };
+        
+        // setup output encoding toggle, note offs go out as velocity 0 note ons while on
+        addAndMakeVisible(compact);
+        compact.setComponentID("compact");
+        compact.setButtonText("compact midi");
+        compact.onClick = [this]
+        {
+            audio::MidiOut::getInstance().setPlayback(audio::PlaybackSettings::compactOutput, compact.getToggleState() ? 1.0f : 0.0f);
         };
     }
     
@@ -90,6 +152,11 @@ namespace gui
         Rectangle<int> playRect = getLocalBounds().removeFromLeft(getLocalBounds().getWidth()
                                                                   / 2.40f);
         
+        // the gap between the play button & the sliders
+        Rectangle<int> legatoRect = getLocalBounds().withTrimmedLeft(playRect.getWidth())
+                                                    .withTrimmedRight(getLocalBounds().getWidth() / 2.0f);
+        Rectangle<int> compactRect = legatoRect.removeFromBottom(legatoRect.getHeight() / 2.0f);
+        
         Rectangle<int> tempoRect = getLocalBounds().removeFromRight(getLocalBounds().getWidth()
                                                                     / 2.0f);
         tempoRect.removeFromTop(getLocalBounds().getHeight() / 2.0f);
@@ -97,11 +164,71 @@ namespace gui
         Rectangle<int> velocityRect = getLocalBounds().removeFromRight(getLocalBounds().getWidth()
                                                                     / 2.0f);
         velocityRect.removeFromBottom(getLocalBounds().getHeight() / 2.0f);
+        
+        Rectangle<int> loadRect = playRect.removeFromBottom(playRect.getHeight() / 3.0f);
+        Rectangle<int> saveRect = loadRect.removeFromLeft(loadRect.getWidth() / 2.0f);
 
         // apply rectangle bounds 
         play.setBounds (playRect);
+        save.setBounds (saveRect);
+        load.setBounds (loadRect);
         tempo.setBounds (tempoRect);
         velocity.setBounds (velocityRect);
+        legato.setBounds (legatoRect);
+        compact.setBounds (compactRect);
+    }
+    
+    //==========================================================================
+    
+    void PlayBackControls::saveProject(const File& file)
+    {
+        audio::MidiOut& midiOut = audio::MidiOut::getInstance();
+        
+        // gather settings from both the sequencer & the synthesiser
+        audio::ProjectSettings settings;
+        zerostruct(settings);
+        midiOut.getSettings(settings);
+        audio.getSettings(settings);
+        
+        if(audio::ProjectFile::save(file, midiOut.getSong(), settings) == false)
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "save",
+                                             "The project could not be saved to " + file.getFullPathName());
+    }
+    
+    void PlayBackControls::loadProject(const File& file)
+    {
+        audio::ProjectFile project (file);
+        
+        if(project.isValid() == false)
+        {
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "load",
+                                             file.getFileName() + " is not a project that can be read");
+            return;
+        }
+        
+        audio::MidiOut::getInstance().loadProject(project);
+        const audio::ProjectSettings settings = project.getSettings();
+        audio.setSettings(settings);
+        
+        // the sliders follow the loaded settings without setting them again
+        tempo.setValue(settings.tempo, dontSendNotification);
+        velocity.setValue(settings.velocity, dontSendNotification);
+        legato.setToggleState(project.getHeader().noteMode == (uint32)audio::MidiEventList::legato, dontSendNotification);
+        compact.setToggleState(settings.compactOutput != 0, dontSendNotification);
+    }
+    
+    void PlayBackControls::exportMidiFile(const File& file)
+    {
+        if(audio::MidiOut::getInstance().exportMidiFile(file) == false)
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "export",
+                                             "The pattern could not be exported to " + file.getFullPathName());
+    }
+    
+    void PlayBackControls::importMidiFile(const File& file)
+    {
+        if(audio::MidiOut::getInstance().importMidiFile(file) == false)
+            AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "import",
+                                             file.getFileName() + " is not a midi file that can be read");
     }
     
 }
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "../../audio/MidiOut.h"
+#include "../../audio/Audio.h"
 #include "../../../JuceLibraryCode/JuceHeader.h"
 
 //==============================================================================
@@ -28,8 +29,9 @@ namespace gui
     public:
         /**
          * Constructor. Contains lambda functions for each control.
+         * @param the audio engine, whose settings are saved with a project.
          */
-        PlayBackControls();
+        PlayBackControls(audio::Audio& audioParam);
         
         /**
          * Destructor.
@@ -46,8 +48,41 @@ namespace gui
         void resized() override;
         
     private:
+        /**
+         *  Saves the patterns & every setting to a project file.
+         *  @param the file to be written.
+         */
+        void saveProject(const File& file);
+        
+        /**
+         *  Loads the patterns & every setting from a project file.
+         *  @param the file to be read.
+         */
+        void loadProject(const File& file);
+        
+        /**
+         *  Exports the pattern to a standard midi file.
+         *  @param the file to be written.
+         */
+        void exportMidiFile(const File& file);
+        
+        /**
+         *  Imports a standard midi file into the pattern.
+         *  @param the file to be read.
+         */
+        void importMidiFile(const File& file);
+        
+        /** The audio engine, for synthesiser settings. */
+        audio::Audio& audio;
+        
         /** Play button */
         TextButton play;
+        /** Button saving the project. */
+        TextButton save;
+        /** Button loading a project. */
+        TextButton load;
+        /** File browser for saving & loading projects. */
+        std::unique_ptr<FileChooser> projectChooser;
         
         /** Tempo control on a slider. */
         Slider tempo;
@@ -59,6 +94,11 @@ namespace gui
         /** Label for velocity control. */
         Label velocityLabel;
         
+        /** Toggles merging runs of steps into single notes. */
+        ToggleButton legato;
+        /** Toggles sending note offs as note ons of velocity 0. */
+        ToggleButton compact;
+        
         
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PlayBackControls)
     };
@@ -25,11 +25,51 @@ namespace gui
         oscChoice.addItem("square", 2);
         oscChoice.addItem("saw",3);
         oscChoice.addItem("triangle",4);
+        oscChoice.addItem("sampler",5);
         oscChoice.onChange = [this]
         {
             audio.setOscillator(oscChoice.getSelectedId());
         };
         
+        // setup sample folder selection
+        addAndMakeVisible(loadSamples);
+        loadSamples.setButtonText("samples");
+        loadSamples.onClick = [this]
+        {
+            sampleChooser = std::make_unique<FileChooser>("Choose a folder of samples");
+            sampleChooser->launchAsync(FileBrowserComponent::openMode
+                                       | FileBrowserComponent::canSelectDirectories,
+                                       [this] (const FileChooser& chooser)
+            {
+                if(chooser.getResult().isDirectory())
+                    audio.loadSamples(chooser.getResult());
+            });
+        };
+        
+        // setup stem routing, each row to its own output channel
+        addAndMakeVisible(stems);
+        stems.setButtonText("stems");
+        stems.onClick = [this]
+        {
+            audio.setStemRouting(stems.getToggleState());
+        };
+        
+        // setup interface selection, for opening devices with many outputs
+        addAndMakeVisible(device);
+        device.setButtonText("device");
+        device.onClick = [this]
+        {
+            DialogWindow::LaunchOptions options;
+            options.content.setOwned(new AudioDeviceSelectorComponent(audio.getAudioDeviceManager(),
+                                                                      0, 0, 1, 32,
+                                                                      false, false, false, false));
+            options.content->setSize(500, 400);
+            options.dialogTitle = "audio device";
+            options.useNativeTitleBar = true;
+            options.resizable = false;
+            options.launchAsync();
+        };
+        
         //======================================================================
         
         // setup filter control
@@ -59,14 +99,21 @@ namespace gui
     void SynthesiserGUI::resized()
     {
         // setup rectangle portions
-        Rectangle<int> oscRect, filterRect;
+        Rectangle<int> oscRect, filterRect, samplesRect, stemsRect, deviceRect;
         oscRect = filterRect = getLocalBounds();
         oscRect.removeFromBottom(getLocalBounds().getHeight() * 0.5);
+        const int buttonWidth = oscRect.getWidth() * 0.2;
+        deviceRect = oscRect.removeFromRight(buttonWidth);
+        stemsRect = oscRect.removeFromRight(buttonWidth);
+        samplesRect = oscRect.removeFromRight(buttonWidth);
         filterRect.removeFromTop(getLocalBounds().getHeight() * 0.5);
         filterRect.removeFromLeft(40/*for label*/);
         
         // set objects to these portions
         oscChoice.setBounds(oscRect);
+        loadSamples.setBounds(samplesRect);
+        stems.setBounds(stemsRect);
+        device.setBounds(deviceRect);
         filter.setBounds(filterRect);
     }
     
@@ -74,15 +121,24 @@ namespace gui
     
     void SynthesiserGUI::timerCallback()
     {
+        // follow settings changed elsewhere, e.g. by loading a project
+        oscChoice.setSelectedId(audio.getOscillator(), dontSendNotification);
+        filter.setValue(audio.getFilterCutoff(), dontSendNotification);
+        stems.setToggleState(audio.getStemRouting(), dontSendNotification);
+        
         if(audio::MidiOut::getInstance().getPlaying() == true)
         {
             oscChoice.setVisible(false);
+            loadSamples.setVisible(false);
+            device.setVisible(false);
             filterLabel.setVisible(false);
             filter.setVisible(false);
         }
         else
         {
             oscChoice.setVisible(true);
+            loadSamples.setVisible(true);
+            device.setVisible(true);
             filterLabel.setVisible(true);
             filter.setVisible(true);
         }
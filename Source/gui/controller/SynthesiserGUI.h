@@ -56,6 +56,16 @@ namespace gui
         /** Choices for oscillator banks. */
         ComboBox oscChoice;
         
+        /** Button choosing the folder of samples for the sampler bank. */
+        TextButton loadSamples;
+        /** Browser for the sample folder, kept alive while open. */
+        std::unique_ptr<FileChooser> sampleChooser;
+        
+        /** Toggle rendering each row to its own output as a stem. */
+        ToggleButton stems;
+        /** Button opening the audio interface settings. */
+        TextButton device;
+        
         /** Slider controlling LPF cutoff. */
         Slider filter;
         /** Label for filter slider */
@@ -14,25 +14,47 @@
 
 namespace gui
 {
-    KeyboardGrid::KeyboardGrid(const int rowCountParam) : rowCount(rowCountParam)
+    KeyboardGrid::KeyboardGrid(const int rowCountParam, audio::Audio& audioParam) : rowCount(rowCountParam),
+                                                                                    audio(audioParam)
     {
         // get the midi output device for settings
         audio::MidiOut& midiOut = audio::MidiOut::getInstance();
+        startNote = (int)midiOut.getSetting(audio::PlaybackSettings::startNote);
         
         for(int row = 0; row < rowCount; row++)
         {
             int inverseRow = rowCount - 1 - row; // so lowest note is at the bottom
-            addAndMakeVisible ( keys.add (new Key (inverseRow + midiOut.getSetting("startnote")) ));
+            addAndMakeVisible ( keys.add (new Key (inverseRow + startNote) ));
+            keys.getLast()->addListener(this);
         }
     }
     
-    KeyboardGrid::~KeyboardGrid(){}
+    KeyboardGrid::~KeyboardGrid()
+    {
+        // keys still held are let go while this grid can still hear them
+        keys.clear();
+    }
     
     void KeyboardGrid::paint (Graphics& g)
     {
         g.fillAll (Colours::darkgrey); // clear the background
     }
     
+    void KeyboardGrid::keyHeldChanged(const int noteNumber, const bool isHeld)
+    {
+        audio::MidiOut& midiOut = audio::MidiOut::getInstance();
+        
+        // sounds as the row's steps do, with its sample & bus
+        const int row = noteNumber - startNote;
+        const audio::RowTarget target = midiOut.getSong().getRowTarget(row);
+        const int note = target.note >= 0 ? target.note : noteNumber;
+        
+        if(isHeld)
+            audio.auditionNoteOn(row, target.channel, note, (uint8)jlimit(1, 127, (int)midiOut.getSetting(audio::PlaybackSettings::velocity)));
+        else
+            audio.auditionNoteOff(target.channel, note);
+    }
+    
     void KeyboardGrid::resized()
     {
         Grid grid;
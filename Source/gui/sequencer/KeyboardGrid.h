@@ -15,24 +15,28 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../widgets/Key.h"
 #include "../../audio/MidiOut.h"
+#include "../../audio/Audio.h"
 
 //==============================================================================
 
 namespace gui
 {
     /*
-     *  A visual representation of an onscreen keyboard within a grid.
+     *  A visual representation of an onscreen keyboard within a grid. Holding
+     *  a key auditions its row on the internal synth.
      */
-    class KeyboardGrid : public Component
+    class KeyboardGrid : public Component,
+                         public Key::Listener
     {
     public:
         /**
          * Constructor. Adds each key to visuals.
          * @param The number of keys to be added.
+         * @param The audio device the keys are auditioned on.
          */
-        KeyboardGrid(const int rowCountParam);
+        KeyboardGrid(const int rowCountParam, audio::Audio& audioParam);
         
-        /** Destructor. */
+        /** Destructor. Releases the note of any key still held. */
         ~KeyboardGrid();
         
         /**
@@ -44,6 +48,14 @@ namespace gui
         /** Sets bounds for sub components.*/
         void resized() override;
         
+        /**
+         *  Starts or stops auditioning the note of a key, on the channel & note
+         *  its row is mapped onto. Sent straight to the synth, not over midi.
+         *  @param the MIDI note value of the key.
+         *  @param true while the key is held down.
+         */
+        void keyHeldChanged(const int noteNumber, const bool isHeld) override;
+    
     private:
         /** Private constructor, must supply no of rows */
         KeyboardGrid();
@@ -51,6 +63,12 @@ namespace gui
         /** Total number of rows (keys) to be added.*/
         int rowCount;
         
+        /** The note number of the bottom key. */
+        int startNote;
+        
+        /** The audio device keys are auditioned on. */
+        audio::Audio& audio;
+        
         /** Pointers to key objects. */
         OwnedArray<Key> keys;
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KeyboardGrid)
@@ -17,7 +17,7 @@ namespace gui
     SequencerGUI::SequencerGUI(audio::Audio& audioParam) : audio(audioParam)
     {
         // add grid components
-        keyGrid = std::make_unique<KeyboardGrid>(ROW_COUNT);
+        keyGrid = std::make_unique<KeyboardGrid>(ROW_COUNT, audio);
         seqGrid = std::make_unique<SequencerGrid>(ROW_COUNT, COLUMN_COUNT);
         addAndMakeVisible(seqGrid.get());
         addAndMakeVisible(keyGrid.get());
@@ -47,12 +47,13 @@ namespace gui
     {
         // split screen bounds into different rectange areas
         Rectangle<int> sequencerRectangle, keyboardRectangle, visualRectangle;
-        sequencerRectangle = keyboardRectangle = visualRectangle = getLocalBounds();
+        sequencerRectangle = keyboardRectangle = getLocalBounds();
         sequencerRectangle.removeFromLeft(getWidth() * 0.30);
         keyboardRectangle.removeFromRight(getWidth() * 0.70);
-        visualRectangle.removeFromTop(getHeight() * 0.10);
-        visualRectangle.removeFromBottom(getHeight() * 0.10);
-        visualRectangle.removeFromLeft(keyboardRectangle.getWidth());
+        
+        // while playing the visualiser takes a strip below the grid, which stays editable
+        if(visual->isVisible())
+            visualRectangle = sequencerRectangle.removeFromBottom(getHeight() * 0.20);
         
         // apply components to these areas
         seqGrid->setBounds(sequencerRectangle);
@@ -62,16 +63,27 @@ namespace gui
     
     void SequencerGUI::playbackStateChanged(bool isPlaying)
     {
-        // change visibility of classes depending on playback state
-        if(isPlaying)
-        {
-            seqGrid.get()->setVisible(false);
-            visual.get()->setVisible(true);
-        }
-        else
+        // the grid is left visible, steps can be edited while playing
+        visual.get()->setVisible(isPlaying);
+        resized();
+    }
+    
+    void SequencerGUI::patternChanged()
+    {
+        // a loaded project may have a different grid size, rebuild to match
+        audio::MidiOut& midiOut = audio::MidiOut::getInstance();
+        const int rowCount = (int)midiOut.getSetting(audio::PlaybackSettings::rowCount);
+        const int columnCount = (int)midiOut.getSetting(audio::PlaybackSettings::columnCount);
+        
+        if(rowCount != seqGrid->getRowCount() || columnCount != seqGrid->getColumnCount())
         {
-            seqGrid.get()->setVisible(true);
-            visual.get()->setVisible(false); 
+            keyGrid = std::make_unique<KeyboardGrid>(rowCount, audio);
+            seqGrid = std::make_unique<SequencerGrid>(rowCount, columnCount);
+            addAndMakeVisible(seqGrid.get());
+            addAndMakeVisible(keyGrid.get());
+            resized();
         }
+        
+        seqGrid.get()->refreshSteps();
     }
 }
@@ -51,6 +51,12 @@ namespace gui
          *  @param  the current state of playback.
          */
         void playbackStateChanged(bool isPlaying) override;
+        
+        /**
+         *  Callback for the steps being replaced, redraws the grid. The grid
+         *  is rebuilt if a loaded project changed its size.
+         */
+        void patternChanged() override;
 
     private:
         /** Pointer for our sequencer grid GIO. */
@@ -17,14 +17,14 @@ namespace gui
     SequencerGrid::SequencerGrid(const int rowCountParam, const int columnCountParam):
     rowCount(rowCountParam), columnCount(columnCountParam)
     {
-        // Rows are assigned to the corresponding midi channel,
-        // so you can only have between 1 to 16 rows.
-        jassert(rowCount > 0 && rowCount <= 16);
+        // Rows are mapped onto a channel & note each, so can share
+        // channels, but a pattern holds at most 128 rows.
+        jassert(rowCount > 0 && rowCount <= audio::Pattern::MAX_ROWS);
         
         // You must have at least on column.
         jassert(columnCount > 0);
         
-        midiOut.setPlayback("colcount", columnCount);
+        midiOut.setGridSize(rowCount, columnCount);
         
         Array< std::shared_ptr<CartesianToggleButton> > column;
         for(int col = 0; col < columnCount; col++)
@@ -78,4 +78,18 @@ namespace gui
         grid.performLayout( getLocalBounds() );
     }
     
+    void SequencerGrid::refreshSteps()
+    {
+        for(int col = 0; col < columnCount; col++)
+        {
+            for(int row = 0; row < rowCount; row++)
+            {
+                int inverseRow = rowCount - 1 - row; // so lowest note is at the bottom
+                steps.getReference(col).getUnchecked(row)->setState(midiOut.getStep(inverseRow, col));
+            }
+        }
+        
+        repaint();
+    }
+    
 } //namespace gui
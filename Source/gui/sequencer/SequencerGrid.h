@@ -50,6 +50,18 @@ namespace gui
          */
         void resized() override;
         
+        /**
+         *  Sets every button to the state of its step in the pattern, e.g.
+         *  after a project has been loaded.
+         */
+        void refreshSteps();
+        
+        /** Accessor for the number of rows. */
+        int getRowCount() const { return rowCount; }
+        
+        /** Accessor for the number of columns. */
+        int getColumnCount() const { return columnCount; }
+    
     private:
         
         /** 
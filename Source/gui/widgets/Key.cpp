@@ -13,16 +13,26 @@
 //==============================================================================
 namespace gui
 {
-    Key::Key(const int noteNumberParam) : noteNumber(noteNumberParam){}
+    Key::Key(const int noteNumberParam) : noteNumber(noteNumberParam)
+    {
+        held = false;
+        listener = nullptr;
+    }
     
-    Key::~Key(){}
+    Key::~Key()
+    {
+        // a key removed while held is let go, so its note doesn't hang
+        if(held && listener != nullptr)
+            listener->keyHeldChanged(noteNumber, false);
+    }
     
     void Key::paint (Graphics& g)
     {
         Colour fillColour = ( MidiMessage::isMidiNoteBlack(noteNumber) == true ? Colours::black : Colours::white );
         Colour textColour = ( MidiMessage::isMidiNoteBlack(noteNumber) == true ? Colours::white : Colours::black );
         
-        g.fillAll (fillColour);
+        // a held key is shaded while its note sounds
+        g.fillAll (held == true ? fillColour.interpolatedWith(Colours::green, 0.5f) : fillColour);
         g.setColour(textColour);
         g.drawText(MidiMessage::getMidiNoteName(noteNumber, true, true, 4),
                    getLocalBounds(),
@@ -31,11 +41,38 @@ namespace gui
     
     void Key::resized(){}
     
+    void Key::mouseDown(const MouseEvent & event)
+    {
+        held = true;
+        
+        if(listener != nullptr)
+            listener->keyHeldChanged(noteNumber, held);
+        
+        repaint();
+    }
+    
+    void Key::mouseUp(const MouseEvent & event)
+    {
+        held = false;
+        
+        if(listener != nullptr)
+            listener->keyHeldChanged(noteNumber, held);
+        
+        repaint();
+    }
+    
     int Key::getNoteNumber() const
     {
         return noteNumber;
     }
     
+    //==========================================================================
+    
+    void Key::addListener (Listener* listenerParam)
+    {
+        listener = listenerParam;
+    }
+    
     
 }
 
@@ -19,7 +19,8 @@
 namespace gui
 {
     /**
-     * A graphical representation of a MIDI note keyboard key.
+     * A graphical representation of a MIDI note keyboard key, held down to
+     * audition its note.
      */
     class Key : public Component
     {
@@ -30,7 +31,7 @@ namespace gui
          */
         Key(const int noteNumberParam);
         
-        /** Destructor. */
+        /** Destructor. Lets the key go if it is still held. */
         ~Key();
         
         
@@ -43,12 +44,51 @@ namespace gui
         /** Sets bounds. */
         void resized() override;
         
+        /**
+         * Holds the key down and broadcasts it.
+         * @param the mouse event triggered.
+         */
+        void mouseDown (const MouseEvent & event) override;
+        
+        /**
+         * Lets the key go and broadcasts it.
+         * @param the mouse event triggered.
+         */
+        void mouseUp (const MouseEvent & event) override;
+        
         /** 
          * Returns the MIDI note value for this key.
          * @return the MIDI note value.
          */
         int getNoteNumber() const;
         
+        //======================================================================
+        
+        /**
+         * Listener for when the key is held or let go.
+         */
+        class Listener
+        {
+        public:
+            /** Destructor. */
+            virtual ~Listener() {}
+            
+            /**
+             * Callback for the key being held or let go.
+             * @param the MIDI note value of the key.
+             * @param true while the key is held down.
+             */
+            virtual void keyHeldChanged(const int noteNumber, const bool isHeld) = 0;
+        };
+        
+        /**
+         * Acessor for the listener object.
+         * @param the pointer this object will be assigned to.
+         */
+        void addListener (Listener* listenerParam);
+        
+        //======================================================================
+    
     private:
         /** Private Constructor */
         Key();
@@ -56,6 +96,12 @@ namespace gui
         /** The MIDI note value for this key. */
         int noteNumber;
         
+        /** True while the key is held down. */
+        bool held;
+        
+        /** Pointer to any listening objects. */
+        Listener* listener;
+        
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Key)
     };
     
@@ -58,6 +58,11 @@ namespace synthesis
             return sample;
         }
         
+        double Oscillator::getSampleRate() const
+        {
+            return sampleRate;
+        }
+        
         void Oscillator::setPhaseIncrement()
         {
             phaseIncrement = (2.f * M_PI * freq) / sampleRate;
@@ -47,7 +47,7 @@ namespace synthesis
              * Setter for amplitude.
              * @param the new amplitude value wanted.
              */
-            void setAmplitude(float ampParam);
+            virtual void setAmplitude(float ampParam);
             
             /**
              * Setter for sampleRate.
@@ -59,7 +59,7 @@ namespace synthesis
              * Returns the next sample needed for an oscillation. 
              * @return the next sample needed for the oscillaton.
              */
-            float getSample();
+            virtual float getSample();
             
             /**
              * The waveshaping function determing the oscillators shape. 
@@ -67,6 +67,14 @@ namespace synthesis
              * @return the altered sample value based on the current phase.
              */
             virtual float waveshape(const float currentPhaseParam) = 0;
+        
+        protected:
+            
+            /**
+             * Getter for the sample rate the oscillator is running at.
+             * @return the current sample rate.
+             */
+            double getSampleRate() const;
             
         private:
             
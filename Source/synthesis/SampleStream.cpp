@@ -0,0 +1,132 @@
+/*
+ ==============================================================================
+ 
+ SampleStream.cpp
+ Created: 18 Oct 2026
+ Author:  agent
+ 
+ ==============================================================================
+ */
+
+#include "SampleStream.h"
+
+namespace synthesis
+{
+    namespace sampler
+    {
+        SampleStream::SampleStream(const File& file)
+        {
+            framesPerPage = 1;
+            for(int voice = 0; voice < MAX_VOICES; ++voice)
+            {
+                playheads[voice].set(-1);
+                prefetched[voice] = 0;
+            }
+            
+            // find a format that can map this file type
+            AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+            AudioFormat* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+            
+            if(format != nullptr)
+                reader.reset(format->createMemoryMappedReader(file));
+            
+            // only wav & aiff can be mapped, anything else is left invalid
+            if(reader == nullptr
+               || reader->numChannels > MAX_CHANNELS
+               || reader->mapEntireFile() == false)
+            {
+                reader = nullptr;
+                return;
+            }
+            
+            // touch roughly one sample per 4kb memory page
+            const int bytesPerFrame = jmax(1, (int)reader->numChannels * (int)reader->bitsPerSample / 8);
+            framesPerPage = jmax(1, 4096 / bytesPerFrame);
+            
+            // preload the head so the first trigger never waits on the disk
+            touchRange(0, jmin((int64)PRELOAD_SAMPLES, reader->lengthInSamples));
+        }
+        
+        SampleStream::~SampleStream(){}
+        
+        //======================================================================
+        
+        bool SampleStream::isValid() const
+        {
+            return reader != nullptr;
+        }
+        
+        int64 SampleStream::getLengthInSamples() const
+        {
+            return isValid() ? reader->lengthInSamples : 0;
+        }
+        
+        double SampleStream::getSampleRate() const
+        {
+            return isValid() ? reader->sampleRate : 44100.0;
+        }
+        
+        float SampleStream::getSample(const int64 index) const
+        {
+            // the sample you are reading is out of range!!!
+            jassert(index >= 0 && index < getLengthInSamples());
+            
+            float frame[MAX_CHANNELS];
+            reader->getSample(index, frame);
+            
+            // mix down to mono
+            float sample = 0.0f;
+            for(int i = 0; i < (int)reader->numChannels; ++i)
+                sample += frame[i];
+            
+            return sample / reader->numChannels;
+        }
+        
+        void SampleStream::setPlayhead(const int voice, const int64 position)
+        {
+            // the voice has no playhead!!!
+            jassert(voice >= 0 && voice < MAX_VOICES);
+            
+            playheads[voice & (MAX_VOICES - 1)].set(position);
+        }
+        
+        //======================================================================
+        
+        int SampleStream::useTimeSlice()
+        {
+            if(isValid() == false)
+                return -1; // nothing to stream
+            
+            // voices playing the sample at once each need the pages ahead of them
+            for(int voice = 0; voice < MAX_VOICES; ++voice)
+            {
+                const int64 position = playheads[voice].get();
+                if(position < 0)
+                    continue; // not reading
+                
+                const int64 end = jmin(position + LOOKAHEAD_SAMPLES, reader->lengthInSamples);
+                int64& touched = prefetched[voice];
+                
+                // a retrigger moves the playhead back to the start
+                if(position < touched - LOOKAHEAD_SAMPLES)
+                    touched = position;
+                
+                if(touched < end)
+                {
+                    touchRange(jmax(touched, position), end);
+                    touched = end;
+                }
+            }
+            
+            return 10;
+        }
+        
+        void SampleStream::touchRange(int64 start, int64 end) const
+        {
+            for(int64 i = start; i < end; i += framesPerPage)
+                reader->touchSample(i);
+        }
+        
+    } // namespace sampler
+} // namespace synthesis
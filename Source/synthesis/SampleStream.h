@@ -0,0 +1,112 @@
+/**
+ *  @file    SampleStream.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  A memory mapped sample file, streamed into memory ahead of its playhead.
+ *
+ */
+
+#pragma once
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+namespace synthesis
+{
+    namespace sampler
+    {
+        /**
+         *  A memory mapped sample file. Only the head of the file is touched
+         *  when loaded, the rest is paged in ahead of every voice's playhead
+         *  by a background TimeSliceThread so the audio thread never page faults.
+         */
+        class SampleStream : public TimeSliceClient
+        {
+        public:
+            /** Most voices that can read a stream at once, each has its own playhead. */
+            static const int MAX_VOICES = 32;
+            
+            /**
+             * Constructor. Maps the file & preloads the head of the sample.
+             * @param the audio file (wav or aiff) to be mapped.
+             */
+            SampleStream(const File& file);
+            
+            /** Destructor. */
+            ~SampleStream();
+            
+            /**
+             * Checks that the file could be memory mapped.
+             * @return true if the sample is ready for playback.
+             */
+            bool isValid() const;
+            
+            /**
+             * Getter for the length of the sample.
+             * @return the number of sample frames in the file.
+             */
+            int64 getLengthInSamples() const;
+            
+            /**
+             * Getter for the sample rate of the file.
+             * @return the sample rate the file was recorded at.
+             */
+            double getSampleRate() const;
+            
+            /**
+             * Returns a single sample mixed down to mono.
+             * @param the frame index within the file.
+             * @return the mono sample value.
+             */
+            float getSample(const int64 index) const;
+            
+            /**
+             * Publishes a voice's read position for the prefetch thread.
+             * @param voice is the index of the voice, below MAX_VOICES.
+             * @param position is the frame index being read, or -1 once the
+             *        voice has stopped reading.
+             */
+            void setPlayhead(const int voice, const int64 position);
+            
+            /**
+             * Touches the pages just ahead of each voice's playhead.
+             * @return the time in ms until this should be called again.
+             */
+            int useTimeSlice() override;
+        
+        private:
+            /** Private constructor. Must provide a file! */
+            SampleStream();
+            
+            /**
+             * Touches each memory page between two frame indexes.
+             * @param start is the first frame to be touched.
+             * @param end is the frame to stop touching at.
+             */
+            void touchRange(int64 start, int64 end) const;
+            
+            /** Frames touched up front when the file is loaded. */
+            static const int PRELOAD_SAMPLES = 65536;
+            /** Frames kept paged in ahead of the playhead. */
+            static const int LOOKAHEAD_SAMPLES = 32768;
+            /** Most channels mixed down when reading a frame. */
+            static const int MAX_CHANNELS = 8;
+            
+            /** The reader holding our memory mapped file. */
+            std::unique_ptr<MemoryMappedAudioFormatReader> reader;
+            
+            /** Frames between each touched memory page. */
+            int64 framesPerPage;
+            /** Current read position published by each voice, -1 if it isn't reading. */
+            Atomic<int64> playheads[MAX_VOICES];
+            /** The furthest frame touched by the prefetch thread for each voice. */
+            int64 prefetched[MAX_VOICES];
+            
+            JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleStream)
+        };
+        
+    } // namespace sampler
+} // namespace synthesis
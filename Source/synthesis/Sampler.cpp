@@ -0,0 +1,85 @@
+/*
+ ==============================================================================
+ 
+ Sampler.cpp
+ Created: 18 Oct 2026
+ Author:  agent
+ 
+ ==============================================================================
+ */
+
+#include "Sampler.h"
+
+namespace synthesis
+{
+    namespace osc
+    {
+        Sampler::Sampler()
+        {
+            stream.set(nullptr);
+            voiceIndex = 0;
+            position = 0.0;
+            gain = 0.0f;
+            retrigger.set(false);
+        }
+        
+        Sampler::~Sampler(){}
+        
+        void Sampler::setVoiceIndex(const int index)
+        {
+            // the stream has no playhead for this voice!!!
+            jassert(index >= 0 && index < sampler::SampleStream::MAX_VOICES);
+            
+            voiceIndex = jlimit(0, sampler::SampleStream::MAX_VOICES - 1, index);
+        }
+        
+        void Sampler::setStream(sampler::SampleStream* streamParam)
+        {
+            // the old stream stops prefetching for this voice
+            sampler::SampleStream* previous = stream.exchange(streamParam);
+            if(previous != nullptr && previous != streamParam)
+                previous->setPlayhead(voiceIndex, -1);
+        }
+        
+        void Sampler::setAmplitude(float ampParam)
+        {
+            // note offs are ignored as one shots play through to the end
+            if(ampParam > 0.0f)
+            {
+                gain = ampParam;
+                retrigger.set(true);
+            }
+        }
+        
+        float Sampler::getSample()
+        {
+            sampler::SampleStream* current = stream.get();
+            if(current == nullptr)
+                return 0.0f;
+            
+            if(retrigger.compareAndSetBool(false, true))
+                position = 0.0;
+            
+            const int64 length = current->getLengthInSamples();
+            const int64 index = (int64)position;
+            if(index >= length)
+            {
+                current->setPlayhead(voiceIndex, -1);
+                return 0.0f; // finished
+            }
+            
+            // linear interpolation between neighbouring frames
+            const float frac = (float)(position - index);
+            float sample = current->getSample(index);
+            if(index + 1 < length)
+                sample += frac * (current->getSample(index + 1) - sample);
+            
+            // step at the ratio of the file to output sample rate
+            position += current->getSampleRate() / getSampleRate();
+            current->setPlayhead(voiceIndex, (int64)position);
+            
+            return sample * gain;
+        }
+        
+    } // namespace osc
+} // namespace synthesis
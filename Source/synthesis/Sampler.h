@@ -0,0 +1,78 @@
+/**
+ *  @file    Sampler.h
+ *  @author  agent
+ *  @date    18/10/2026
+ *  @version 1.0
+ *
+ *  @section DESCRIPTION
+ *
+ *  A one shot sample playback voice reading from a memory mapped stream.
+ *
+ */
+
+#pragma once
+
+#include "Oscillator.h"
+#include "SampleStream.h"
+
+namespace synthesis
+{
+    namespace osc
+    {
+        /**
+         *  A one shot sample playback voice. Any note on restarts the sample
+         *  which then plays through to its end regardless of note offs.
+         */
+        class Sampler : public Oscillator
+        {
+        public:
+            /** Constructor. Starts with no sample loaded. */
+            Sampler();
+            
+            /** Destructor. */
+            ~Sampler();
+            
+            /**
+             * Sets the playhead this voice publishes to its stream.
+             * @param the index of the voice, below SampleStream::MAX_VOICES.
+             */
+            void setVoiceIndex(const int index);
+            
+            /**
+             * Sets the sample to be played by this voice, releasing the
+             * playhead it held on the last one. Audio thread only.
+             * @param the stream to read from, or nullptr for silence.
+             */
+            void setStream(sampler::SampleStream* streamParam);
+            
+            /**
+             * Retriggers the sample for any non zero amplitude.
+             * @param the velocity the sample is played back at.
+             */
+            void setAmplitude(float ampParam) override;
+            
+            /**
+             * Reads the next sample from the stream, resampled to the output rate.
+             * @return the next sample of the one shot.
+             */
+            float getSample() override;
+            
+            /** Samples are not phase driven. @see getSample */
+            float waveshape(const float currentPhase) override { return 0.0f; }
+        
+        private:
+            /** The sample currently assigned to this voice. */
+            Atomic<sampler::SampleStream*> stream;
+            
+            /** The playhead of this voice in each stream. */
+            int voiceIndex;
+            /** Fractional read position within the stream. */
+            double position;
+            /** The playback gain set by the last note on. */
+            float gain;
+            /** Set when a note on has asked for a restart. */
+            Atomic<bool> retrigger;
+        };
+        
+    } // namespace osc
+} // namespace synthesis